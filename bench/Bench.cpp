@@ -0,0 +1,198 @@
+//
+//  Bench.cpp
+//  Mochi
+//
+//  Usage: Mochi-bench [--filter <text>] [--min-time <ms>] [--repetitions <n>]
+//                     [--producers <n>] [--events <n>]
+//
+
+#include "Bench.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+#ifndef MOCHI_BENCH_BUILD_TYPE
+#define MOCHI_BENCH_BUILD_TYPE ""
+#endif
+
+namespace MochiBench {
+
+    HistogramSum::HistogramSum() : _counts(MLatencyHistogram::BucketCount), _count(0), _sum(0), _max(0) {}
+
+    void HistogramSum::Add(const MLatencyHistogram& histogram) {
+        for (::MOCHI_NAMESPACE::UInt32 i = 0; i < MLatencyHistogram::BucketCount; i++) {
+            _counts[i] += histogram.GetBucketCount(i);
+        }
+
+        _count += histogram.GetCount();
+        _sum += (MUInt64) (histogram.GetMean() * (double) histogram.GetCount());
+        _max = std::max(_max, histogram.GetMax());
+    }
+
+    MUInt64 HistogramSum::GetValueAtPercentile(double percentile) const {
+        MUInt64 total = 0;
+        for (auto count : _counts) {
+            total += count;
+        }
+
+        if (total == 0) return 0;
+
+        auto rank = std::max<MUInt64>((MUInt64) std::ceil(percentile / 100.0 * (double) total), 1);
+        MUInt64 seen = 0;
+        for (::MOCHI_NAMESPACE::UInt32 i = 0; i < MLatencyHistogram::BucketCount; i++) {
+            seen += _counts[i];
+            if (seen >= rank) return std::min(MLatencyHistogram::GetBucketUpperBound(i), _max);
+        }
+
+        return _max;
+    }
+
+    Json::Value HistogramSum::ToJson() const {
+        Json::Value result(Json::objectValue);
+        result["count"] = (Json::UInt64) _count;
+        result["mean"] = _count == 0 ? 0.0 : (double) _sum / (double) _count;
+        result["p50"] = (Json::UInt64) GetValueAtPercentile(50);
+        result["p90"] = (Json::UInt64) GetValueAtPercentile(90);
+        result["p99"] = (Json::UInt64) GetValueAtPercentile(99);
+        result["p999"] = (Json::UInt64) GetValueAtPercentile(99.9);
+        result["max"] = (Json::UInt64) _max;
+        return result;
+    }
+
+    // MARK: -
+
+    Runner::Runner(Options options) : _options(std::move(options)) {
+        _writer["indentation"] = "";
+        _writer["precision"] = 6;
+        _writer["emitUTF8"] = true;
+    }
+
+    MBool Runner::IsSelected(std::string_view name) const {
+        return _options.filter.empty() || name.find(_options.filter) != std::string_view::npos;
+    }
+
+    void Runner::Measure(std::string_view suite,
+                         std::string_view name,
+                         Json::Value params,
+                         const Body& body) {
+        if (!IsSelected(name)) return;
+
+        using Clock = std::chrono::steady_clock;
+        auto time = [&body](std::size_t iterations) {
+            auto start = Clock::now();
+            body(iterations);
+            return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        };
+
+        // Warm up, then grow the iteration count until a run is long enough to extrapolate from
+        double minNanos = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(_options.minTime).count();
+        std::size_t iterations = 1;
+        double elapsed = time(iterations);
+        while (elapsed < minNanos / 10 && iterations < ((std::size_t) 1 << 40)) {
+            iterations *= 10;
+            elapsed = time(iterations);
+        }
+
+        iterations = std::max<std::size_t>(1, (std::size_t) ((double) iterations * minNanos / std::max(elapsed, 1.0)));
+
+        std::vector<double> samples;
+        for (std::size_t i = 0; i < _options.repetitions; i++) {
+            samples.push_back(time(iterations) / (double) iterations);
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        Json::Value nanos(Json::objectValue);
+        nanos["median"] = samples[samples.size() / 2];
+        nanos["min"] = samples.front();
+        nanos["max"] = samples.back();
+
+        Json::Value result(Json::objectValue);
+        result["params"] = std::move(params);
+        result["iterations"] = (Json::UInt64) iterations;
+        result["repetitions"] = (Json::UInt64) samples.size();
+        result["ns_per_op"] = std::move(nanos);
+        Report(suite, name, std::move(result));
+    }
+
+    void Runner::Report(std::string_view suite, std::string_view name, Json::Value result) {
+        result["type"] = "result";
+        result["suite"] = std::string(suite);
+        result["benchmark"] = std::string(name);
+        std::cout << Json::writeString(_writer, result) << std::endl;
+    }
+
+    void Runner::ReportContext() {
+        Json::Value context(Json::objectValue);
+        context["type"] = "context";
+        context["timestamp"] = (Json::Int64) std::time(nullptr);
+        context["build_type"] = MOCHI_BENCH_BUILD_TYPE;
+        context["hardware_threads"] = std::thread::hardware_concurrency();
+
+#if defined(__clang__)
+        context["compiler"] = "clang " __clang_version__;
+#elif defined(__GNUC__)
+        context["compiler"] = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        context["compiler"] = "msvc " + std::to_string(_MSC_FULL_VER);
+#endif
+
+        Json::Value options(Json::objectValue);
+        options["filter"] = _options.filter;
+        options["min_time_ms"] = (Json::Int64) _options.minTime.count();
+        options["repetitions"] = (Json::UInt64) _options.repetitions;
+        options["max_producers"] = (Json::UInt64) _options.maxProducers;
+        options["events_per_producer"] = (Json::UInt64) _options.eventsPerProducer;
+        context["options"] = std::move(options);
+
+        std::cout << Json::writeString(_writer, context) << std::endl;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    MochiBench::Options options;
+
+    for (int i = 1; i < argc; i++) {
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << argv[i] << "\n";
+                std::exit(1);
+            }
+
+            return argv[++i];
+        };
+
+        try {
+            if (!std::strcmp(argv[i], "--filter")) {
+                options.filter = next();
+            } else if (!std::strcmp(argv[i], "--min-time")) {
+                options.minTime = std::chrono::milliseconds(std::stoll(next()));
+            } else if (!std::strcmp(argv[i], "--repetitions")) {
+                options.repetitions = std::max<std::size_t>(1, std::stoull(next()));
+            } else if (!std::strcmp(argv[i], "--producers")) {
+                options.maxProducers = std::max<std::size_t>(1, std::stoull(next()));
+            } else if (!std::strcmp(argv[i], "--events")) {
+                options.eventsPerProducer = std::max<std::size_t>(1, std::stoull(next()));
+            } else {
+                std::cerr << "Usage: " << argv[0] << " [--filter <text>] [--min-time <ms>] [--repetitions <n>]"
+                          << " [--producers <n>] [--events <n>]\n";
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << argv[i - 1] << "\n";
+            return 1;
+        }
+    }
+
+    MochiBench::Runner runner(options);
+    runner.ReportContext();
+
+    MochiBench::RunColorBenchmarks(runner);
+    MochiBench::RunComponentBenchmarks(runner);
+    MochiBench::RunLoggingBenchmarks(runner);
+    return 0;
+}
@@ -0,0 +1,110 @@
+//
+//  Bench.h
+//  Mochi
+//
+//  A small harness for the Mochi-bench suites. Every result is written to stdout as one
+//  JSON object per line, so runs can be diffed or loaded into a spreadsheet as they are.
+//
+
+#pragma once
+
+#include <Mochi/Core.h>
+#include <Mochi/LogMetrics.h>
+#include <json/json.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MochiBench {
+
+    using MBool = ::MOCHI_NAMESPACE::Bool;
+    using MUInt64 = ::MOCHI_NAMESPACE::UInt64;
+    using MLatencyHistogram = ::MOCHI_NAMESPACE::LatencyHistogram;
+
+    struct Options {
+        /// @brief Only benchmarks whose name contains this string are run.
+        std::string filter;
+
+        /// @brief Each repetition of a microbenchmark runs for at least this long.
+        std::chrono::milliseconds minTime { 200 };
+
+        std::size_t repetitions = 5;
+
+        /// @brief The logging benchmarks run with 1, 2, 4, ... producers up to this many.
+        std::size_t maxProducers = 4;
+
+        /// @brief The number of events every producer logs per repetition.
+        std::size_t eventsPerProducer = 100000;
+    };
+
+    /// @brief Keeps the compiler from optimizing away the computation of `value`.
+    template <typename T>
+    inline void DoNotOptimize(const T& value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        static const void* volatile sink;
+        sink = &value;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+    /// @brief Bucket counts added up from several `LatencyHistogram`s, e.g. one per producer.
+    class HistogramSum {
+    public:
+        HistogramSum();
+
+        void Add(const MLatencyHistogram& histogram);
+
+        MUInt64 GetCount() const { return _count; }
+
+        /// @brief Writes the count, mean, max and the usual percentiles into an object.
+        Json::Value ToJson() const;
+
+    private:
+        MUInt64 GetValueAtPercentile(double percentile) const;
+
+        std::vector<MUInt64> _counts;
+        MUInt64 _count;
+        MUInt64 _sum;
+        MUInt64 _max;
+    };
+
+    class Runner {
+    public:
+        /// @brief The body runs the operation `iterations` times in a loop of its own.
+        using Body = std::function<void(std::size_t iterations)>;
+
+        explicit Runner(Options options);
+
+        const Options& GetOptions() const { return _options; }
+
+        MBool IsSelected(std::string_view name) const;
+
+        /// @brief Times `body` and reports nanoseconds per operation over the repetitions.
+        /// The iteration count is picked once so that a repetition takes about `minTime`.
+        void Measure(std::string_view suite,
+                     std::string_view name,
+                     Json::Value params,
+                     const Body& body);
+
+        /// @brief Writes a result line. `suite` and `benchmark` are filled in.
+        void Report(std::string_view suite, std::string_view name, Json::Value result);
+
+        /// @brief Writes the line describing the machine and build, which starts every run.
+        void ReportContext();
+
+    private:
+        Options _options;
+        Json::StreamWriterBuilder _writer;
+    };
+
+    void RunLoggingBenchmarks(Runner& runner);
+    void RunComponentBenchmarks(Runner& runner);
+    void RunColorBenchmarks(Runner& runner);
+
+}
@@ -0,0 +1,89 @@
+//
+//  ColorBench.cpp
+//  Mochi
+//
+
+#include "Bench.h"
+#include <Mochi/Components.h>
+#include <numbers>
+#include <random>
+
+using MColor = ::MOCHI_NAMESPACE::Color;
+using MTextColor = ::MOCHI_NAMESPACE::TextColor;
+using MIStyle = ::MOCHI_NAMESPACE::IStyle;
+using MBasicColoredStyle = ::MOCHI_NAMESPACE::BasicColoredStyle;
+
+namespace MochiBench {
+
+    // A fixed seed keeps the inputs identical from one run to the next
+    static constexpr std::size_t InputCount = 256;
+    static constexpr unsigned InputSeed = 0x4d6f6368;
+
+    struct Hsv {
+        double hue;
+        double saturation;
+        double value;
+    };
+
+    void RunColorBenchmarks(Runner& runner) {
+        std::mt19937 random(InputSeed);
+
+        std::vector<MColor> colors;
+        std::uniform_int_distribution<::MOCHI_NAMESPACE::UInt32> rgb(0, 0xffffff);
+        for (std::size_t i = 0; i < InputCount; i++) {
+            colors.emplace_back(rgb(random));
+        }
+
+        std::vector<Hsv> hsvs;
+        std::uniform_real_distribution<double> hue(-std::numbers::pi * 4, std::numbers::pi * 4);
+        std::uniform_real_distribution<double> unit(0, 1);
+        for (std::size_t i = 0; i < InputCount; i++) {
+            hsvs.push_back({ hue(random), unit(random), unit(random) });
+        }
+
+        runner.Measure("color", "Color.ToHsv", Json::objectValue, [&colors](std::size_t iterations) {
+            double h, s, v;
+            for (std::size_t i = 0; i < iterations; i++) {
+                colors[i % InputCount].ToHsv(&h, &s, &v);
+                DoNotOptimize(h);
+                DoNotOptimize(s);
+                DoNotOptimize(v);
+            }
+        });
+
+        runner.Measure("color", "Color.FromHsv", Json::objectValue, [&hsvs](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; i++) {
+                auto &hsv = hsvs[i % InputCount];
+                DoNotOptimize(MColor::FromHsv(hsv.hue, hsv.saturation, hsv.value));
+            }
+        });
+
+        // BasicColoredStyle::ApplyTo, for each kind of pair a visitor runs into
+        auto empty = std::static_pointer_cast<MIStyle>(MBasicColoredStyle::Empty());
+        auto uncolored = std::static_pointer_cast<MIStyle>(::MOCHI_NAMESPACE::CreateRef<MBasicColoredStyle>());
+        auto red = std::static_pointer_cast<MIStyle>(MBasicColoredStyle::Of(MTextColor::Red));
+        auto blue = std::static_pointer_cast<MIStyle>(MBasicColoredStyle::Of(MTextColor::Blue));
+
+        struct Pair {
+            const char* name;
+            MIStyle::Ref style;
+            MIStyle::Ref parent;
+        };
+
+        for (auto &pair : {
+            Pair { "colored_onto_empty", red, empty },
+            Pair { "uncolored_onto_colored", uncolored, red },
+            Pair { "colored_onto_colored", red, blue }
+        }) {
+            Json::Value params(Json::objectValue);
+            params["case"] = pair.name;
+
+            runner.Measure("color", "BasicColoredStyle.ApplyTo", params, [&pair](std::size_t iterations) {
+                for (std::size_t i = 0; i < iterations; i++) {
+                    DoNotOptimize(pair.style->ApplyTo(pair.parent));
+                }
+            });
+        }
+    }
+
+}
@@ -0,0 +1,212 @@
+//
+//  ComponentBench.cpp
+//  Mochi
+//
+
+#include "Bench.h"
+#include <Mochi/Components.h>
+#include <memory>
+
+using MIComponent = ::MOCHI_NAMESPACE::IComponent;
+using MIContent = ::MOCHI_NAMESPACE::IContent;
+using MIContentVisitor = ::MOCHI_NAMESPACE::IContentVisitor;
+using MIStyle = ::MOCHI_NAMESPACE::IStyle;
+using MIMutableComponent = ::MOCHI_NAMESPACE::IMutableComponent;
+using MTextColor = ::MOCHI_NAMESPACE::TextColor;
+using MBasicColoredStyle = ::MOCHI_NAMESPACE::BasicColoredStyle;
+using MComponentBuilder = ::MOCHI_NAMESPACE::ComponentBuilder;
+using MComponentRuns = ::MOCHI_NAMESPACE::ComponentRuns;
+
+namespace MochiBench {
+
+    static MIComponent::Ref CreateComponent(MBool styled) {
+        auto component = ::MOCHI_NAMESPACE::Component::Literal("The quick brown fox jumps over the lazy dog");
+        if (styled) {
+            auto mutableComponent = std::dynamic_pointer_cast<MIMutableComponent>(component);
+            mutableComponent->SetStyle(MBasicColoredStyle::Of(MTextColor::Gold));
+        }
+
+        return component;
+    }
+
+    /// @brief The number of colored siblings appended to the root of a tree.
+    static constexpr std::size_t TreeSiblingCount = 16;
+
+    static const MTextColor::Ref TreeColors[] = {
+        MTextColor::Gold, MTextColor::Aqua, MTextColor::Red, MTextColor::Gray
+    };
+
+    static const char* const TreeColorNames[] = { "gold", "aqua", "red", "gray" };
+
+    // A chat-like line: a plain root followed by short colored pieces
+    static MIMutableComponent::Ref CreateTree() {
+        auto root = std::dynamic_pointer_cast<MIMutableComponent>(::MOCHI_NAMESPACE::Component::Literal("<Player> "));
+        for (std::size_t i = 0; i < TreeSiblingCount; i++) {
+            auto sibling = std::dynamic_pointer_cast<MIMutableComponent>(::MOCHI_NAMESPACE::Component::Literal("word "));
+            sibling->SetStyle(MBasicColoredStyle::Of(TreeColors[i % 4]));
+            root->Append(std::move(sibling));
+        }
+
+        return root;
+    }
+
+    static MIMutableComponent::Ref CreateTree(MComponentBuilder& builder) {
+        auto root = builder.Literal("<Player> ");
+        for (std::size_t i = 0; i < TreeSiblingCount; i++) {
+            root->Append(builder.Literal("word ", TreeColors[i % 4]));
+        }
+
+        return root;
+    }
+
+    void RunComponentBenchmarks(Runner& runner) {
+        for (MBool styled : { false, true }) {
+            auto component = CreateComponent(styled);
+
+            Json::Value params(Json::objectValue);
+            params["styled"] = styled;
+
+            runner.Measure("components", "IComponent.Clone", params, [&component](std::size_t iterations) {
+                for (std::size_t i = 0; i < iterations; i++) {
+                    DoNotOptimize(component->Clone());
+                }
+            });
+
+            // One visitor for the whole run, the way a sink would keep one around
+            std::size_t visited = 0;
+            auto visitor = MIContentVisitor::Create([&visited](MIContent::Ref, MIStyle::Ref) {
+                visited++;
+            });
+
+            MIStyle::Ref root = MBasicColoredStyle::Empty();
+            runner.Measure("components", "IComponent.Visit", params, [&](std::size_t iterations) {
+                for (std::size_t i = 0; i < iterations; i++) {
+                    component->Visit(visitor, root);
+                }
+
+                DoNotOptimize(visited);
+            });
+
+            runner.Measure("components", "IComponent.VisitLiteral", params, [&](std::size_t iterations) {
+                for (std::size_t i = 0; i < iterations; i++) {
+                    component->VisitLiteral(visitor, root);
+                }
+
+                DoNotOptimize(visited);
+            });
+
+            runner.Measure("components", "Component.AppendPlainText", params, [&component](std::size_t iterations) {
+                std::string text;
+                for (std::size_t i = 0; i < iterations; i++) {
+                    text.clear();
+                    ::MOCHI_NAMESPACE::Component::AppendPlainText(component, text);
+                    DoNotOptimize(text);
+                }
+            });
+        }
+
+        Json::Value tree(Json::objectValue);
+        tree["siblings"] = (Json::UInt64) TreeSiblingCount;
+
+        // Building and dropping a whole tree, the way log and chat messages are used
+        Json::Value heap = tree;
+        heap["allocation"] = "heap";
+        runner.Measure("components", "Component.BuildTree", heap, [](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; i++) {
+                DoNotOptimize(CreateTree());
+            }
+        });
+
+        Json::Value arena = tree;
+        arena["allocation"] = "arena";
+        runner.Measure("components", "Component.BuildTree", arena, [](std::size_t iterations) {
+            MComponentBuilder builder;
+            for (std::size_t i = 0; i < iterations; i++) {
+                DoNotOptimize(CreateTree(builder));
+                builder.Reset();
+            }
+        });
+
+        for (auto &params : { heap, arena }) {
+            MComponentBuilder builder;
+            MIComponent::Ref component = params["allocation"] == "arena" ? CreateTree(builder) : CreateTree();
+
+            runner.Measure("components", "IComponent.Clone", params, [&component](std::size_t iterations) {
+                for (std::size_t i = 0; i < iterations; i++) {
+                    DoNotOptimize(component->Clone());
+                }
+            });
+
+            std::size_t visited = 0;
+            auto visitor = MIContentVisitor::Create([&visited](MIContent::Ref, MIStyle::Ref) {
+                visited++;
+            });
+
+            MIStyle::Ref root = MBasicColoredStyle::Empty();
+            runner.Measure("components", "IComponent.Visit", params, [&](std::size_t iterations) {
+                for (std::size_t i = 0; i < iterations; i++) {
+                    component->Visit(visitor, root);
+                }
+
+                DoNotOptimize(visited);
+            });
+
+            runner.Measure("components", "ComponentRuns.Compile", params, [&component](std::size_t iterations) {
+                for (std::size_t i = 0; i < iterations; i++) {
+                    DoNotOptimize(MComponentRuns::Compile(component));
+                }
+            });
+
+            // What a broadcast pays per recipient once the message is compiled
+            auto runs = MComponentRuns::Compile(component);
+            runner.Measure("components", "ComponentRuns.Iterate", params, [&runs](std::size_t iterations) {
+                std::size_t length = 0;
+                for (std::size_t i = 0; i < iterations; i++) {
+                    for (auto run : runs) {
+                        length += run.text.size();
+                        DoNotOptimize(run.style.get());
+                    }
+                }
+
+                DoNotOptimize(length);
+            });
+        }
+
+        // Decoding a chat message the way the ingest path receives it
+        Json::Value json(Json::objectValue);
+        json["text"] = "<Player> ";
+        json["extra"] = Json::Value(Json::arrayValue);
+        for (std::size_t i = 0; i < TreeSiblingCount; i++) {
+            Json::Value sibling(Json::objectValue);
+            sibling["text"] = "word ";
+            sibling["color"] = TreeColorNames[i % 4];
+            sibling["bold"] = i % 2 == 0;
+            json["extra"].append(sibling);
+        }
+
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        auto text = Json::writeString(writer, json);
+
+        Json::Value document = tree;
+        document["parser"] = "document";
+        runner.Measure("components", "Component.FromJson", document, [&text](std::size_t iterations) {
+            Json::CharReaderBuilder builder;
+            std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+            for (std::size_t i = 0; i < iterations; i++) {
+                Json::Value value;
+                reader->parse(text.data(), text.data() + text.size(), &value, nullptr);
+                DoNotOptimize(::MOCHI_NAMESPACE::Component::FromJson(value));
+            }
+        });
+
+        Json::Value streaming = tree;
+        streaming["parser"] = "streaming";
+        runner.Measure("components", "Component.FromJson", streaming, [&text](std::size_t iterations) {
+            for (std::size_t i = 0; i < iterations; i++) {
+                DoNotOptimize(::MOCHI_NAMESPACE::Component::ParseJson(text));
+            }
+        });
+    }
+
+}
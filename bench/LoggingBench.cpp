@@ -0,0 +1,195 @@
+//
+//  LoggingBench.cpp
+//  Mochi
+//
+
+#include "Bench.h"
+#include <Mochi/Logging.h>
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+using MLogPipeline = ::MOCHI_NAMESPACE::LogPipeline;
+using MLogLevel = ::MOCHI_NAMESPACE::LogLevel;
+using MLoggerEventBatch = ::MOCHI_NAMESPACE::LoggerEventBatch;
+using MIAsyncLogEventDelegate = ::MOCHI_NAMESPACE::IAsyncLogEventDelegate;
+using MWaitStrategy = ::MOCHI_NAMESPACE::WaitStrategy;
+
+namespace MochiBench {
+
+    /// @brief How the event loop of the pipeline under test is driven.
+    struct PollingMode {
+        const char* name;
+        MBool manual;
+        MWaitStrategy strategy;
+    };
+
+    static const PollingMode PollingModes[] = {
+        { "BusySpin", false, MWaitStrategy::BusySpin },
+        { "SpinThenPark", false, MWaitStrategy::SpinThenPark },
+        { "Blocking", false, MWaitStrategy::Blocking },
+        { "ManualPoll", true, MWaitStrategy::BusySpin }
+    };
+
+    /// @brief One call in this many is timed, so reading the clock barely shows in the throughput.
+    static constexpr std::size_t CallSampleRate = 8;
+
+    struct ThroughputRun {
+        double eventsPerSecond;
+        MUInt64 dropped;
+    };
+
+    // Every run gets a pipeline of its own: the default one behind `Logger` can only be
+    // bootstrapped once per process. The pipeline code is the same either way.
+    static ThroughputRun RunThroughput(const PollingMode& mode,
+                                       std::size_t producers,
+                                       std::size_t events,
+                                       HistogramSum& calls,
+                                       HistogramSum& dispatch) {
+        MLogPipeline pipeline;
+
+        // Stand-in for a sink: renders every message but writes it nowhere
+        std::string scratch;
+        pipeline.AddLoggedListener(MIAsyncLogEventDelegate::CreateBatched([&scratch](MLoggerEventBatch batch) {
+            for (auto &ev : batch) {
+                scratch.clear();
+                ::MOCHI_NAMESPACE::Component::AppendPlainText(ev->content, scratch);
+            }
+
+            return ::MOCHI_NAMESPACE::Future::Completed();
+        }));
+
+        std::atomic<MBool> polling = true;
+        std::atomic<MBool> bootstrapped = false;
+        std::thread poller;
+
+        if (mode.manual) {
+            poller = std::thread([&]() {
+                pipeline.RunManualPoll();
+                bootstrapped = true;
+
+                while (polling.load(std::memory_order_relaxed)) {
+                    pipeline.PollEvents();
+                }
+
+                pipeline.PollEvents();
+            });
+
+            while (!bootstrapped) std::this_thread::yield();
+        } else {
+            pipeline.SetWaitStrategy(mode.strategy);
+            pipeline.RunThreaded();
+        }
+
+        std::vector<std::unique_ptr<MLatencyHistogram>> histograms;
+        for (std::size_t i = 0; i < producers; i++) {
+            histograms.push_back(std::make_unique<MLatencyHistogram>());
+        }
+
+        std::atomic<MBool> start = false;
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < producers; p++) {
+            threads.emplace_back([&, p]() {
+                auto &histogram = *histograms[p];
+                while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+
+                for (std::size_t i = 0; i < events; i++) {
+                    if (i % CallSampleRate == 0) {
+                        auto begin = std::chrono::steady_clock::now();
+                        pipeline.Info("Bench event {} from producer {}", i, p);
+                        auto elapsed = std::chrono::steady_clock::now() - begin;
+                        histogram.Record((MUInt64) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+                    } else {
+                        pipeline.Info("Bench event {} from producer {}", i, p);
+                    }
+                }
+            });
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        start.store(true, std::memory_order_release);
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        // Every event has been handled once the flush hook queued behind them has run
+        pipeline.FlushAsync().wait();
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        if (mode.manual) {
+            polling = false;
+            poller.join();
+        }
+
+        for (auto &histogram : histograms) {
+            calls.Add(*histogram);
+        }
+
+        dispatch.Add(pipeline.GetLatencyHistogram());
+        return { (double) (producers * events) / seconds, pipeline.GetDroppedCount() };
+    }
+
+    void RunLoggingBenchmarks(Runner& runner) {
+        auto &options = runner.GetOptions();
+
+        // The cost of a statement below the minimum level, which should be next to nothing
+        {
+            MLogPipeline pipeline;
+            pipeline.RunManualPoll();
+            pipeline.SetMinimumLevel(MLogLevel::Warn);
+
+            runner.Measure("logging", "LogPipeline.Info.Disabled", Json::objectValue, [&pipeline](std::size_t iterations) {
+                for (std::size_t i = 0; i < iterations; i++) {
+                    pipeline.Info("Bench event {}", i);
+                }
+            });
+        }
+
+        if (!runner.IsSelected("LogPipeline.Throughput")) return;
+
+        std::vector<std::size_t> producerCounts;
+        for (std::size_t count = 1; count < options.maxProducers; count *= 2) {
+            producerCounts.push_back(count);
+        }
+
+        producerCounts.push_back(options.maxProducers);
+
+        for (auto &mode : PollingModes) {
+            for (auto producers : producerCounts) {
+                HistogramSum calls;
+                HistogramSum dispatch;
+                std::vector<double> rates;
+                MUInt64 dropped = 0;
+
+                for (std::size_t i = 0; i < options.repetitions; i++) {
+                    auto run = RunThroughput(mode, producers, options.eventsPerProducer, calls, dispatch);
+                    rates.push_back(run.eventsPerSecond);
+                    dropped += run.dropped;
+                }
+
+                std::sort(rates.begin(), rates.end());
+
+                Json::Value params(Json::objectValue);
+                params["mode"] = mode.name;
+                params["producers"] = (Json::UInt64) producers;
+                params["events_per_producer"] = (Json::UInt64) options.eventsPerProducer;
+
+                Json::Value rate(Json::objectValue);
+                rate["median"] = rates[rates.size() / 2];
+                rate["min"] = rates.front();
+                rate["max"] = rates.back();
+
+                Json::Value result(Json::objectValue);
+                result["params"] = std::move(params);
+                result["repetitions"] = (Json::UInt64) rates.size();
+                result["events_per_sec"] = std::move(rate);
+                result["call_ns"] = calls.ToJson();
+                result["dispatch_latency_ns"] = dispatch.ToJson();
+                result["dropped"] = (Json::UInt64) dropped;
+                runner.Report("logging", "LogPipeline.Throughput", std::move(result));
+            }
+        }
+    }
+
+}
@@ -12,7 +12,15 @@
 #include <list>
 #include <json/json.h>
 #include <Mochi/Foundation.h>
+#include <Mochi/JsonReader.h>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
 #include <sstream>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace MOCHI_NAMESPACE {
 
@@ -23,6 +31,13 @@ namespace MOCHI_NAMESPACE {
 
         virtual Handle<IContent> CreateContent(Json::Value payload) = 0;
         virtual void InsertPayload(Json::Value target, Handle<IContent> content) = 0;
+        
+        /// @brief Creates the content from the value of `key`, the member that selected this
+        /// type, read straight from `reader`. `key` is only valid until the reader is used.
+        ///
+        /// By default the value is read into a document and passed to `CreateContent` as
+        /// `{ key: value }`. Override it to skip the document.
+        virtual Handle<IContent> ReadContent(std::string_view key, JsonReader& reader);
     };
 
     class IStyle : public std::enable_shared_from_this<IStyle> {
@@ -64,6 +79,10 @@ namespace MOCHI_NAMESPACE {
         virtual IContent::Ref GetContent() = 0;
         virtual IStyle::Ref GetStyle() = 0;
         virtual std::list<Ref> GetSiblings() = 0;
+        
+        /// @brief Returns a copy that can be changed without affecting this component, and that
+        /// later changes to this component or to siblings the caller still holds do not affect.
+        /// Siblings nobody else holds are shared instead of copied, so cloning a tree is cheap.
         virtual Handle<IMutableComponent> Clone() = 0;
         virtual void Visit(IContentVisitor::Ref visitor, IStyle::Ref style) = 0;
         virtual void VisitLiteral(IContentVisitor::Ref visitor, IStyle::Ref style) = 0;
@@ -73,6 +92,10 @@ namespace MOCHI_NAMESPACE {
     public:
         using Ref = Handle<IMutableComponent>;
         virtual void SetStyle(IStyle::Ref style) = 0;
+        
+        /// @brief Adds `sibling` after the existing siblings. It is rendered with this
+        /// component's style applied.
+        virtual void Append(IComponent::Ref sibling) = 0;
     };
 
     #define __MC_DEFINE_COLORS \
@@ -97,6 +120,13 @@ namespace MOCHI_NAMESPACE {
 
         TextColor(char code, std::string name, Color color);
         
+        /// @brief Gets the number of colors created before this one. Unique per color.
+        int GetOrdinal() const { return _ordinal; }
+        
+        /// @brief Finds a builtin color by its name in JSON, such as `dark_red`.
+        /// @return The color, or null if there is none by that name.
+        static Ref FromName(std::string_view name);
+        
 #define __MC_DEFINE_COLOR(id, code, name, color) \
     const static Ref id ;
     __MC_DEFINE_COLORS
@@ -104,7 +134,7 @@ namespace MOCHI_NAMESPACE {
         
     private:
         using ByCharMap = std::map<char,        Ref>;
-        using ByNameMap = std::map<std::string, Ref>;
+        using ByNameMap = std::map<std::string, Ref, std::less<>>;
 
         char _code;
         std::string _name;
@@ -124,16 +154,34 @@ namespace MOCHI_NAMESPACE {
     public:
         using Ref = Handle<IColoredStyle>;
         virtual TextColor::Ref GetColor() = 0;
-        virtual Ref WithColor(TextColor::Ref color) = 0;
+        
+        /// @brief Gets a style like this one but with `color`. Styles may be shared, so this one
+        /// is not changed. Replaces `WithColor()`, which used to set the color in place.
+        [[nodiscard]] virtual Ref Recolored(TextColor::Ref color) = 0;
     };
 
+    /// @brief A style that only carries a color. Instances are immutable and interned: there is
+    /// one per color, so equal styles are the same object and can be compared by pointer.
+    ///
+    /// Combining two styles never creates a new one, since the result is always one of them.
+    /// Visiting a tree therefore allocates no styles, however deep it is.
     class BasicColoredStyle : public IColoredStyle {
     public:
         using Ref = Handle<BasicColoredStyle>;
+        
+        /// @brief Gets the style without a color, which is also the identity of `ApplyTo`.
         static Ref Empty();
+        
+        /// @brief Gets the one style with the given color, or `Empty()` for a null color.
+        static Ref Of(TextColor::Ref color);
+        
+        /// @brief Reads the `color` member of a JSON component. The default `JsonStyleParseFn`.
+        static Ref FromJson(Json::Value obj);
 
         TextColor::Ref GetColor() override;
-        IColoredStyle::Ref WithColor(TextColor::Ref color) override;
+        
+        /// @brief Gets the interned style with `color`, the same as `Of(color)`.
+        [[nodiscard]] IColoredStyle::Ref Recolored(TextColor::Ref color) override;
         IStyle::Ref ApplyTo(IStyle::Ref other) override;
         void SerializeInto(Json::Value obj) override;
         IStyle::Ref Clear() override;
@@ -147,20 +195,25 @@ namespace MOCHI_NAMESPACE {
 
     class TextContentTypes {
     public:
-        using Registry = std::map<std::string, IContentType::Ref>;
+        using Registry = std::map<std::string, IContentType::Ref, std::less<>>;
 
     private:
-        static Registry _types;
+        /// @brief The registry, created on first use so that types can be registered while
+        /// other translation units are still being initialized.
+        static Registry& GetTypes();
         static Handle<LiteralContentType> e_Literal;
         
     public:
         template<class T>
         static Handle<T> Register(std::string key, Handle<T> type) {
-            _types[key] = type;
+            GetTypes()[key] = type;
             return type;
         }
         
         static Handle<LiteralContentType> Literal();
+        
+        /// @brief Gets the type registered under `key`, or null if there is none.
+        static IContentType::Ref Find(std::string_view key);
     };
 
     class LiteralContent : public IContent {
@@ -185,19 +238,227 @@ namespace MOCHI_NAMESPACE {
 
         IContent::Ref CreateContent(Json::Value payload) override;
         void InsertPayload(Json::Value target, IContent::Ref content) override;
+        IContent::Ref ReadContent(std::string_view key, JsonReader& reader) override;
     };
 
     namespace Component {
 
+        /// @brief Reads the style of a component from its JSON object. When reading from text,
+        /// the object only has the members that are neither content nor `extra`.
         using JsonStyleParseFn = std::function<IStyle::Ref(Json::Value)>;
 
+        /// @brief Creates a component from a JSON document: a string, an array whose first
+        /// element has the others appended, or an object with a member naming one of the
+        /// `TextContentTypes`, a style, and siblings under `extra`.
+        ///
+        /// If an object has members for several content types, the one whose key sorts first
+        /// is used, wherever it appears in the object.
         IComponent::Ref FromJson(Json::Value obj,
                                 JsonStyleParseFn parseStyle);
         IComponent::Ref FromJson(Json::Value obj);
+        
+        /// @brief Like `FromJson()`, but reads the component straight from JSON text, without
+        /// building a document. Content comes from `IContentType::ReadContent()`, picked the same
+        /// way. Without a `parseStyle`, only `color` is read and other members are skipped unparsed.
+        IComponent::Ref ParseJson(std::string_view json,
+                                  JsonStyleParseFn parseStyle);
+        IComponent::Ref ParseJson(std::string_view json);
+        
+        /// @brief Reads the component that comes next in `reader`, for components embedded in
+        /// larger documents.
+        IComponent::Ref ReadJson(JsonReader& reader,
+                                 JsonStyleParseFn parseStyle);
+        IComponent::Ref ReadJson(JsonReader& reader);
         IComponent::Ref Literal(std::string text);
+        
+        /// @brief Appends the text of every literal in the tree to `out`, ignoring styles.
+        void AppendPlainText(const IComponent::Ref& component, std::string& out);
 
     };
 
+    /// @brief A component tree flattened into the runs of text it renders as, each with its
+    /// style already resolved against the styles of its parents.
+    ///
+    /// Compile a message once, then render or serialize it as often as needed by walking the
+    /// runs in order: the tree is not visited again and no style is resolved twice. The runs
+    /// are a snapshot; later changes to the tree are not reflected.
+    ///
+    ///     auto runs = ComponentRuns::Compile(message);
+    ///     for (auto run : runs) {
+    ///         out << Ansi(run.style) << run.text;
+    ///     }
+    class ComponentRuns {
+    private:
+        struct Entry {
+            std::size_t offset;
+            std::size_t length;
+            IStyle::Ref style;
+        };
+        
+    public:
+        /// @brief A view of one run. Only valid as long as the `ComponentRuns` it came from.
+        struct Run {
+            std::string_view text;
+            const IStyle::Ref& style;
+        };
+        
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Run;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Run;
+            
+            Iterator() : _text(nullptr), _entry(nullptr) {}
+            
+            Run operator*() const {
+                return Run { std::string_view(_text + _entry->offset, _entry->length), _entry->style };
+            }
+            
+            Iterator& operator++() {
+                ++_entry;
+                return *this;
+            }
+            
+            Iterator operator++(int) {
+                auto copy = *this;
+                ++*this;
+                return copy;
+            }
+            
+            Bool operator==(const Iterator& other) const { return _entry == other._entry; }
+            
+        private:
+            Iterator(const char* text, const Entry* entry) : _text(text), _entry(entry) {}
+            
+            const char* _text;
+            const Entry* _entry;
+            
+            friend class ComponentRuns;
+        };
+        
+        /// @brief Flattens `component` as it would be visited with `style` as the outer style.
+        /// Neighboring pieces that resolve to the same style object are merged into one run.
+        static ComponentRuns Compile(const IComponent::Ref& component,
+                                     IStyle::Ref style = BasicColoredStyle::Empty());
+        
+        std::size_t GetCount() const { return _entries.size(); }
+        Bool IsEmpty() const { return _entries.empty(); }
+        
+        Run operator[](std::size_t index) const {
+            auto &entry = _entries[index];
+            return Run { std::string_view(_text).substr(entry.offset, entry.length), entry.style };
+        }
+        
+        /// @brief Gets the text of every run, back to back.
+        std::string_view GetText() const { return _text; }
+        
+        Iterator begin() const { return Iterator(_text.data(), _entries.data()); }
+        Iterator end() const { return Iterator(_text.data(), _entries.data() + _entries.size()); }
+        
+    private:
+        std::string _text;
+        std::vector<Entry> _entries;
+    };
+
+    /// @brief A bump allocator that component trees are built in. See `ComponentBuilder`.
+    ///
+    /// Allocations are carved out of a few large blocks, and giving one back only counts it.
+    /// The blocks are freed together once the owner released the arena and the last allocation
+    /// is given back, so a tree can outlive its builder.
+    ///
+    /// Only the owner's thread allocates from the blocks while it holds the arena, and it counts
+    /// without atomics. Other threads, and everyone after `Release()`, are handed memory from
+    /// `std::pmr::get_default_resource()` instead; those are counted too, and keep the arena alive
+    /// until they are given back. Allocations can be given back from any thread at any time.
+    class ComponentArena : public std::pmr::memory_resource {
+    public:
+        static constexpr std::size_t DefaultBlockSize = 4096;
+        
+        /// @brief Creates an arena owned by the calling thread, to be given up with `Release()`.
+        static ComponentArena* Create(std::size_t blockSize = DefaultBlockSize);
+        
+        /// @brief Gives up ownership. The arena is freed now if nothing allocated from it is left.
+        void Release();
+        
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+        
+    private:
+        struct Block {
+            Block* next;
+            UInt8* end;
+        };
+        
+        explicit ComponentArena(std::size_t blockSize);
+        ~ComponentArena();
+        
+        void* AllocateFromNewBlock(std::size_t bytes, std::size_t alignment);
+        void Settle(std::ptrdiff_t count);
+        
+        /// @brief Whether `p` was carved out of one of the blocks. Safe from any thread.
+        Bool Contains(const void* p) const;
+        
+        std::size_t _blockSize;
+        std::atomic<Block*> _blocks;
+        UInt8* _cursor;
+        UInt8* _end;
+        std::thread::id _owner;
+        std::atomic<Bool> _isOwned;
+        
+        /// @brief Allocations minus deallocations the owner counted on its own thread.
+        std::ptrdiff_t _ownerBalance;
+        
+        /// @brief Everything else: allocations handed to the default resource, deallocations on
+        /// other threads, and all of them after `Release()`. Starts at `OwnerHold`, so it cannot
+        /// reach zero before `Release()` swaps the hold for the owner's balance. The arena is freed
+        /// when it does.
+        std::atomic<std::ptrdiff_t> _sharedBalance;
+        
+        static constexpr std::ptrdiff_t OwnerHold = PTRDIFF_MAX / 2;
+    };
+
+    /// @brief Builds component trees whose nodes, contents and sibling lists all live in one
+    /// `ComponentArena`, next to their reference counts. Styles are interned, not allocated.
+    ///
+    /// Building a node is a pointer bump instead of a heap allocation per object, and a tree is
+    /// freed in one step once its last handle is dropped. Use one builder per thread. Text too long
+    /// for the small-string buffer of `std::string` is still allocated on the heap.
+    ///
+    ///     ComponentBuilder builder;
+    ///     auto message = builder.Literal("Player ");
+    ///     message->Append(builder.Literal(name, TextColor::Gold));
+    ///     message->Append(builder.Literal(" joined the game"));
+    class ComponentBuilder {
+    public:
+        explicit ComponentBuilder(std::size_t blockSize = ComponentArena::DefaultBlockSize);
+        ~ComponentBuilder();
+        
+        ComponentBuilder(const ComponentBuilder&) = delete;
+        ComponentBuilder& operator=(const ComponentBuilder&) = delete;
+        
+        IMutableComponent::Ref Literal(std::string_view text);
+        IMutableComponent::Ref Literal(std::string_view text, TextColor::Ref color);
+        IMutableComponent::Ref Create(IContent::Ref content, IStyle::Ref style);
+        IColoredStyle::Ref Style(TextColor::Ref color);
+        
+        /// @brief Starts a new arena for the next tree. Trees built so far stay valid; their arena
+        /// is freed once the last of them is.
+        void Reset();
+        
+    private:
+        template <typename T, typename... TArgs>
+        Handle<T> Allocate(TArgs&&... args) {
+            return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(_arena), std::forward<TArgs>(args)...);
+        }
+        
+        std::size_t _blockSize;
+        ComponentArena* _arena;
+    };
+
 }
 
 #endif /* components_hpp */
@@ -0,0 +1,259 @@
+/// Concurrent.h
+/// --
+/// Lock-free building blocks shared by the logging pipeline.
+
+#pragma once
+
+#if defined(__cplusplus)
+#ifndef __MOCHI_CONCURRENT_H_HEADER_GUARD
+#define __MOCHI_CONCURRENT_H_HEADER_GUARD
+
+#include <Mochi/Core.h>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#   include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#   include <immintrin.h>
+#endif
+
+namespace MOCHI_NAMESPACE {
+
+    /// @brief Size used to keep independently written atomics on separate cache lines.
+    constexpr std::size_t CacheLineSize = 64;
+
+    /// @brief Tells the CPU that the calling thread is in a spin-wait loop.
+    inline void CpuRelax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+
+    /// @brief Describes how a consumer thread waits for work to arrive.
+    enum class WaitStrategy {
+        /// @brief Never gives up the core. Lowest latency, burns a full core while idle.
+        BusySpin,
+
+        /// @brief Spins for a bounded number of rounds, then parks until notified.
+        SpinThenPark,
+
+        /// @brief Parks as soon as there is nothing to do.
+        Blocking
+    };
+
+    /// @brief Lets a single consumer thread sleep while idle, and lets producers wake it up.
+    ///
+    /// Producers call `Notify()` after publishing work. It costs a fence and a relaxed load
+    /// unless the consumer is actually parked, in which case it also wakes the consumer through
+    /// `std::atomic::wait`/`notify_one` (a futex on Linux).
+    class IdleWaiter {
+    public:
+        static constexpr UInt32 DefaultSpinCount = 4096;
+
+        IdleWaiter(WaitStrategy strategy = WaitStrategy::SpinThenPark,
+                   UInt32 spinCount = DefaultSpinCount)
+        : _strategy(strategy), _spinCount(spinCount), _parked(false), _epoch(0) {}
+
+        IdleWaiter(const IdleWaiter&) = delete;
+        IdleWaiter& operator=(const IdleWaiter&) = delete;
+
+        /// @brief Changes the strategy. Only call this while the consumer is not waiting.
+        void SetStrategy(WaitStrategy strategy, UInt32 spinCount = DefaultSpinCount) {
+            _strategy = strategy;
+            _spinCount = spinCount;
+        }
+
+        WaitStrategy GetStrategy() const { return _strategy; }
+
+        /// @brief Blocks the consumer until `ready()` returns `true`.
+        template <typename TPredicate>
+        void Wait(TPredicate ready) {
+            if (ready()) return;
+
+            if (_strategy == WaitStrategy::BusySpin) {
+                while (!ready()) CpuRelax();
+                return;
+            }
+
+            UInt32 spins = _strategy == WaitStrategy::Blocking ? 0 : _spinCount;
+            for (UInt32 i = 0; i < spins; i++) {
+                if (ready()) return;
+
+                // Back off to the scheduler during the second half of the spin phase
+                if (i < spins / 2) {
+                    CpuRelax();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+
+            for (;;) {
+                UInt32 epoch = _epoch.load(std::memory_order_acquire);
+                _parked.store(true, std::memory_order_relaxed);
+
+                // Pairs with the fence in Notify(): either the producer sees us parked,
+                // or we see the work it published before going to sleep.
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                if (ready()) {
+                    _parked.store(false, std::memory_order_relaxed);
+                    return;
+                }
+
+                _epoch.wait(epoch, std::memory_order_acquire);
+                _parked.store(false, std::memory_order_relaxed);
+                if (ready()) return;
+            }
+        }
+
+        /// @brief Wakes the consumer if it is parked. Call after publishing work.
+        void Notify() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!_parked.load(std::memory_order_relaxed)) return;
+            Wake();
+        }
+
+        /// @brief Unconditionally wakes the consumer, e.g. to let it observe a shutdown request.
+        void Wake() {
+            _epoch.fetch_add(1, std::memory_order_release);
+            _epoch.notify_one();
+        }
+
+    private:
+        WaitStrategy _strategy;
+        UInt32 _spinCount;
+        alignas(CacheLineSize) std::atomic<Bool> _parked;
+        std::atomic<UInt32> _epoch;
+    };
+
+    /// @brief A bounded, lock-free ring buffer (Vyukov's sequence-per-cell design).
+    ///
+    /// Producers claim a cell with a single CAS on the enqueue cursor, store the value and
+    /// publish it by bumping the cell's sequence number. Cells are consumed strictly in the
+    /// order they were claimed, so anything enqueued after an item is also dequeued after it.
+    /// Dequeuing is lock-free as well, so producers may also take cells out, e.g. to drop
+    /// the oldest value when the buffer is full.
+    /// @tparam T The element type. It must be default constructible and move assignable.
+    template <typename T>
+    class ConcurrentRingBuffer {
+    public:
+        /// @param capacity The requested capacity. It is rounded up to a power of two.
+        explicit ConcurrentRingBuffer(std::size_t capacity)
+        : _capacity(RoundUpCapacity(capacity)), _mask(_capacity - 1),
+          _cells(std::make_unique<Cell[]>(_capacity)), _enqueuePos(0), _dequeuePos(0) {
+            for (std::size_t i = 0; i < _capacity; i++) {
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ConcurrentRingBuffer(const ConcurrentRingBuffer&) = delete;
+        ConcurrentRingBuffer& operator=(const ConcurrentRingBuffer&) = delete;
+
+        /// @brief Tries to append a value to the buffer.
+        /// @return `false` if the buffer is full, in which case `value` is left untouched.
+        Bool TryEnqueue(T&& value) {
+            Cell* cell;
+            std::size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+
+            for (;;) {
+                cell = &_cells[pos & _mask];
+                std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+                auto diff = (std::ptrdiff_t) seq - (std::ptrdiff_t) pos;
+
+                if (diff == 0) {
+                    if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    // The consumer has not released this cell yet
+                    return false;
+                } else {
+                    pos = _enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->value = std::move(value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        Bool TryEnqueue(const T& value) {
+            T copy = value;
+            return TryEnqueue(std::move(copy));
+        }
+
+        /// @brief Tries to take the oldest value out of the buffer.
+        /// @return `false` if the buffer is empty.
+        Bool TryDequeue(T& out) {
+            Cell* cell;
+            std::size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+
+            for (;;) {
+                cell = &_cells[pos & _mask];
+                std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+                auto diff = (std::ptrdiff_t) seq - (std::ptrdiff_t) (pos + 1);
+
+                if (diff == 0) {
+                    if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = _dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            out = std::move(cell->value);
+            cell->value = T();
+            cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::size_t GetCapacity() const { return _capacity; }
+        
+        /// @brief Gets the number of values enqueued since the buffer was created.
+        std::size_t GetEnqueuedCount() const {
+            return _enqueuePos.load(std::memory_order_relaxed);
+        }
+
+        /// @brief Gets an approximate number of queued values.
+        std::size_t GetSize() const {
+            auto enqueued = _enqueuePos.load(std::memory_order_relaxed);
+            auto dequeued = _dequeuePos.load(std::memory_order_relaxed);
+            return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+        /// @brief Checks whether the next cell to be consumed has been published yet.
+        Bool IsEmpty() const {
+            std::size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+            std::size_t seq = _cells[pos & _mask].sequence.load(std::memory_order_acquire);
+            return (std::ptrdiff_t) seq - (std::ptrdiff_t) (pos + 1) < 0;
+        }
+
+    private:
+        struct alignas(CacheLineSize) Cell {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        static std::size_t RoundUpCapacity(std::size_t capacity) {
+            std::size_t result = 2;
+            while (result < capacity) result <<= 1;
+            return result;
+        }
+
+        const std::size_t _capacity;
+        const std::size_t _mask;
+        std::unique_ptr<Cell[]> _cells;
+        alignas(CacheLineSize) std::atomic<std::size_t> _enqueuePos;
+        alignas(CacheLineSize) std::atomic<std::size_t> _dequeuePos;
+    };
+
+}
+
+#endif
+#endif
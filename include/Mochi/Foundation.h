@@ -68,9 +68,8 @@ namespace MOCHI_NAMESPACE {
         requires Concepts::IsDerived<T, TBase>
     #endif // defined(MOCHI_CPLUSPLUS_HAS_CXX20)
     Handle<T> AssertSubType(Handle<TBase> value) {
-        std::stringstream str;
-        
         if (!value) {
+            std::stringstream str;
             str << "Expected object of type " << typeid(T).name() << " but received null instead.";
             throw std::runtime_error(str.str());
         }
@@ -79,6 +78,7 @@ namespace MOCHI_NAMESPACE {
             return result;
         }
         
+        std::stringstream str;
         str << "Object " << value << " (typeof " << typeid(TBase).name() << ")";
         str << " must be derived type " << typeid(T).name() << " to be used in this context.";
         throw std::runtime_error(str.str());
@@ -178,11 +178,17 @@ namespace MOCHI_NAMESPACE {
 
     class Future {
     public:
+        static std::future<void> Completed() {
+            std::promise<void> promise;
+            promise.set_value();
+            return promise.get_future();
+        }
+        
         template<typename C>
         static std::future<void> WhenAll(C &futures) {
             std::promise<void> promise;
             
-            for (auto future : futures) {
+            for (auto &future : futures) {
                 future.wait();
             }
             
@@ -204,7 +210,7 @@ namespace MOCHI_NAMESPACE {
             
         }
         
-        std::list<HandlerEntry> GetHandlers() {
+        const std::list<HandlerEntry>& GetHandlers() const {
             return _handlers;
         }
         
@@ -0,0 +1,99 @@
+/// JsonReader.h
+/// --
+/// A pull parser that reads JSON straight from the text, without building a document.
+
+#pragma once
+
+#if defined(__cplusplus)
+#ifndef __MOCHI_JSON_READER_H_HEADER_GUARD
+#define __MOCHI_JSON_READER_H_HEADER_GUARD
+
+#include <Mochi/Foundation.h>
+#include <json/json.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace MOCHI_NAMESPACE {
+
+    /// @brief Reads one JSON value token by token. The caller walks the structure and asks for
+    /// what it expects next; anything else makes the reader throw a `std::runtime_error` that
+    /// names the offset.
+    ///
+    /// Strings without escapes are handed out as views into the input, so the input has to
+    /// outlive the views. Nothing is allocated unless a string has to be unescaped.
+    ///
+    ///     JsonReader reader(text);
+    ///     reader.BeginObject();
+    ///     std::string_view key;
+    ///     while (reader.NextKey(key)) {
+    ///         if (key == "name") name = reader.ReadString();
+    ///         else reader.Skip();
+    ///     }
+    ///     reader.ExpectEnd();
+    class JsonReader {
+    public:
+        /// @brief The deepest nesting of arrays and objects that is accepted.
+        static constexpr std::size_t MaxDepth = 512;
+
+        explicit JsonReader(std::string_view json);
+
+        /// @brief Gets the type of the next value without reading it. Numbers are `realValue`.
+        Json::ValueType Peek();
+
+        /// @brief Reads a string. The view is valid until the next call on this reader.
+        std::string_view ReadStringView();
+        std::string ReadString() { return std::string(ReadStringView()); }
+
+        /// @brief Reads a number as it was written.
+        std::string_view ReadNumberText();
+        double ReadNumber();
+        Bool ReadBool();
+        void ReadNull();
+
+        void BeginObject();
+
+        /// @brief Reads the key of the next member of the current object, or the closing brace.
+        /// The key is valid until the next call on this reader.
+        /// @return false once the object is over.
+        Bool NextKey(std::string_view& key);
+
+        void BeginArray();
+
+        /// @brief Moves on to the next element of the current array, or past the closing bracket.
+        /// @return false once the array is over.
+        Bool NextElement();
+
+        /// @brief Reads the next value, whatever it is, and drops it.
+        void Skip();
+
+        /// @brief Reads the next value into a document, for code that still takes a `Json::Value`.
+        Json::Value ReadValue();
+
+        /// @brief Checks that nothing but whitespace is left.
+        void ExpectEnd();
+
+        std::size_t GetOffset() const { return _cursor; }
+
+        [[noreturn]] void Fail(std::string_view reason) const;
+
+    private:
+        void SkipWhitespace();
+        void Expect(char c);
+        void Enter();
+        std::string_view ReadLiteral(std::string_view word);
+        void AppendEscape();
+
+        std::string_view _json;
+        std::size_t _cursor;
+        std::size_t _depth;
+
+        // Whether the next member or element is the first one of its object or array
+        Bool _isFirst;
+        std::string _scratch;
+    };
+
+}
+
+#endif
+#endif
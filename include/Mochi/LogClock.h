@@ -0,0 +1,100 @@
+/// LogClock.h
+/// --
+/// Cheap timestamps for log events, and a formatter that only redoes the calendar math
+/// once per second.
+
+#pragma once
+
+#if defined(__cplusplus)
+#ifndef __MOCHI_LOG_CLOCK_H_HEADER_GUARD
+#define __MOCHI_LOG_CLOCK_H_HEADER_GUARD
+
+#include <Mochi/Core.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace MOCHI_NAMESPACE {
+
+    /// @brief Where `LogClock::Now()` gets the time from.
+    enum class LogClockSource {
+        /// @brief `std::chrono::system_clock`.
+        System,
+
+        /// @brief The kernel's coarse wall clock (`CLOCK_REALTIME_COARSE` on Linux). Much cheaper,
+        /// but only advances once per scheduler tick (usually 1-4 ms).
+        Coarse,
+
+        /// @brief The CPU timestamp counter, calibrated against the wall clock and re-anchored
+        /// about once per second. Only available on x86 CPUs with an invariant TSC.
+        Tsc
+    };
+
+    /// @brief The clock used to stamp log events.
+    class LogClock {
+    public:
+        using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
+
+        static TimePoint Now() {
+            switch (_source.load(std::memory_order_relaxed)) {
+                case LogClockSource::Coarse:
+                    return CoarseNow();
+                case LogClockSource::Tsc:
+                    return TscNow();
+                default:
+                    return std::chrono::system_clock::now();
+            }
+        }
+
+        static Bool IsSupported(LogClockSource source);
+
+        /// @brief Switches the clock source. Selecting `Tsc` calibrates the counter first,
+        /// which blocks the caller for a few milliseconds.
+        /// @return `false` if the source is not supported here, in which case nothing changes.
+        static Bool SetSource(LogClockSource source);
+        static LogClockSource GetSource();
+
+    private:
+        static TimePoint CoarseNow();
+        static TimePoint TscNow();
+        static TimePoint Resync(UInt64 tsc);
+
+        static std::atomic<LogClockSource> _source;
+
+        // The TSC anchor is published through a sequence lock: odd while being rewritten.
+        static std::atomic<UInt32> _anchorSequence;
+        static std::atomic<UInt64> _anchorTsc;
+        static std::atomic<Int64>  _anchorNanos;
+        static std::atomic<UInt64> _nanosPerTick;    // 32.32 fixed point
+        static std::atomic<UInt64> _resyncTicks;
+    };
+
+    enum class TimestampPrecision {
+        Seconds, Milliseconds, Microseconds
+    };
+
+    /// @brief Formats timestamps as `YYYY-MM-DD HH:MM:SS.fff`.
+    ///
+    /// The date and time of day are cached for the last second seen, so consecutive events
+    /// within the same second only rewrite the sub-second digits. Not thread-safe; give each
+    /// sink its own instance.
+    class TimestampFormatter {
+    public:
+        explicit TimestampFormatter(TimestampPrecision precision = TimestampPrecision::Milliseconds,
+                                    Bool utc = false);
+
+        void Append(std::string& out, LogClock::TimePoint timestamp);
+        std::string Format(LogClock::TimePoint timestamp);
+
+    private:
+        TimestampPrecision _precision;
+        Bool _utc;
+        Int64 _cachedSecond;
+        std::size_t _prefixLength;
+        char _prefix[32];
+    };
+
+}
+
+#endif
+#endif
@@ -0,0 +1,97 @@
+/// LogCrashRing.h
+/// --
+/// A memory-mapped ring of recent log records that survives a crash of the process.
+
+#pragma once
+
+#if defined(__cplusplus)
+#ifndef __MOCHI_LOG_CRASH_RING_H_HEADER_GUARD
+#define __MOCHI_LOG_CRASH_RING_H_HEADER_GUARD
+
+#include <Mochi/Logging.h>
+#include <Mochi/LogSinks.h>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace MOCHI_NAMESPACE {
+
+    /// @brief Keeps the most recent events in a file mapped into memory, so that the events
+    /// still waiting in the logger queue can be recovered after a crash.
+    ///
+    /// Register it with `LogPipeline::SetCrashRing()`. Producers then copy every event into the
+    /// next slot of the ring before queueing it; a message that is formatted later is stored as
+    /// its format string and packed arguments. Nothing is synced: the kernel writes the pages
+    /// back on its own, so the records survive the process dying, but not the machine losing
+    /// power (see `Sync()`). Read the records back with `Recover()` or `Mochi-logdecode --crash`.
+    ///
+    /// The file starts with a 64-byte header followed by `slotCount` slots of `slotSize` bytes.
+    /// Each slot holds a sequence number, a checksum, the level, timestamp and thread of the
+    /// event, its tag, its text and its structured fields. Text that does not fit in a slot is
+    /// cut short; fields are only kept whole, so those past the end of the slot are left out.
+    class LogCrashRing {
+    public:
+        using Ref = Handle<LogCrashRing>;
+
+        static constexpr char Magic[8] = { 'M', 'O', 'C', 'H', 'I', 'R', 'N', 'G' };
+        static constexpr UInt32 Version = 1;
+        static constexpr std::size_t HeaderSize = 64;
+        static constexpr std::size_t DefaultSlotCount = 4096;
+        static constexpr std::size_t DefaultSlotSize = 512;
+
+        /// @brief Creates the ring file at `path`. An existing file is first renamed to
+        /// `<path>.prev`, so restarting after a crash does not wipe what it left behind.
+        /// @param slotSize Rounded up to a multiple of 64 bytes.
+        explicit LogCrashRing(const std::string& path,
+                              std::size_t slotCount = DefaultSlotCount,
+                              std::size_t slotSize = DefaultSlotSize);
+        ~LogCrashRing();
+
+        LogCrashRing(const LogCrashRing&) = delete;
+        LogCrashRing& operator=(const LogCrashRing&) = delete;
+
+        /// @brief Asks the OS to write the mapped pages to disk, without waiting for it.
+        void Sync();
+
+        const std::string& GetPath() const { return _path; }
+        std::size_t GetSlotCount() const { return _slotCount; }
+        std::size_t GetSlotSize() const { return _slotSize; }
+
+        /// @brief Reads the records left in a ring file, oldest first.
+        /// Slots that were being written when the process died fail their checksum and are skipped.
+        /// Records whose fields did not all fit end in " [truncated]", like cut-off text.
+        /// @param maxRecords Only the most recent this many records are returned.
+        /// Throws if the file is not a crash ring.
+        static std::vector<DecodedLogRecord> Recover(const std::string& path,
+                                                     std::size_t maxRecords = std::numeric_limits<std::size_t>::max());
+
+    private:
+        /// @brief Copies an event into the next slot. Safe to call from any number of threads.
+        /// Only `LogPipeline` writes to the ring, because every event it sees comes from its
+        /// `LoggerEventPool`, and the unformatted parts of pooled events are read directly.
+        void Write(const LoggerEventPool::Entry& entry);
+
+        void Map();
+        void Unmap();
+
+        std::string _path;
+        std::size_t _slotCount;
+        std::size_t _slotSize;
+        std::size_t _mappedSize;
+        UInt8* _data;
+
+#if defined(_WIN32)
+        void* _file;
+        void* _mapping;
+#else
+        int _fd;
+#endif
+
+        friend class LogPipeline;
+    };
+
+}
+
+#endif
+#endif
@@ -0,0 +1,175 @@
+/// LogFields.h
+/// --
+/// Typed key/value fields attached to log events, packed into a small inline buffer so that
+/// short lists cost no allocation and sinks can walk them without copying.
+
+#pragma once
+
+#if defined(__cplusplus)
+#ifndef __MOCHI_LOG_FIELDS_H_HEADER_GUARD
+#define __MOCHI_LOG_FIELDS_H_HEADER_GUARD
+
+#include <Mochi/Core.h>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace MOCHI_NAMESPACE {
+
+    enum class LogFieldType : UInt8 {
+        Int64, UInt64, Double, Bool, String
+    };
+
+    /// @brief A key and a typed value.
+    ///
+    /// This is only a view: the key and string values point to whatever the field was made
+    /// from. Fields handed to a logger are copied into the event, and fields read back from
+    /// `LogFields` point into its buffer.
+    class LogField {
+    public:
+        template <typename T>
+        LogField(std::string_view key, const T& value) : _key(key), _uint(0) {
+            using TValue = std::remove_cvref_t<T>;
+
+            if constexpr (std::is_same_v<TValue, Bool>) {
+                _type = LogFieldType::Bool;
+                _bool = value;
+            } else if constexpr (std::is_enum_v<TValue>) {
+                _type = LogFieldType::Int64;
+                _int = (Int64) value;
+            } else if constexpr (std::is_integral_v<TValue> && std::is_signed_v<TValue>) {
+                _type = LogFieldType::Int64;
+                _int = value;
+            } else if constexpr (std::is_integral_v<TValue>) {
+                _type = LogFieldType::UInt64;
+                _uint = value;
+            } else if constexpr (std::is_floating_point_v<TValue>) {
+                _type = LogFieldType::Double;
+                _double = value;
+            } else if constexpr (std::is_convertible_v<const TValue&, std::string_view>) {
+                _type = LogFieldType::String;
+                if constexpr (std::is_pointer_v<TValue>) {
+                    _string = value ? std::string_view(value) : std::string_view("(null)");
+                } else {
+                    _string = value;
+                }
+            } else {
+                static_assert(std::is_arithmetic_v<TValue>, "Log fields hold integers, doubles, bools and strings.");
+            }
+        }
+
+        std::string_view GetKey() const { return _key; }
+        LogFieldType GetType() const { return _type; }
+
+        Int64 GetInt64() const { return _int; }
+        UInt64 GetUInt64() const { return _uint; }
+        double GetDouble() const { return _double; }
+        Bool GetBool() const { return _bool; }
+        std::string_view GetString() const { return _string; }
+
+        /// @brief Appends the value as plain text: numbers in their shortest form, bools as
+        /// `true`/`false` and strings unquoted.
+        void AppendValue(std::string& out) const;
+
+    private:
+        std::string_view _key;
+        LogFieldType _type;
+        union {
+            Int64 _int;
+            UInt64 _uint;
+            double _double;
+            Bool _bool;
+        };
+        std::string_view _string;
+    };
+
+    /// @brief An ordered list of fields, copied into a buffer of their own.
+    ///
+    /// Each field is packed as its type, key and value. Up to `InlineSize` bytes live inside the
+    /// object itself; longer lists move to the heap. Iterating yields `LogField` views into the
+    /// buffer, so reading the fields never allocates.
+    class LogFields {
+    public:
+        static constexpr std::size_t InlineSize = 128;
+
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = LogField;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = LogField;
+
+            Iterator() : _data(nullptr), _offset(0) {}
+
+            LogField operator*() const;
+            Iterator& operator++();
+            Iterator operator++(int) {
+                auto copy = *this;
+                ++*this;
+                return copy;
+            }
+
+            Bool operator==(const Iterator& other) const { return _offset == other._offset; }
+
+        private:
+            Iterator(const UInt8* data, std::size_t offset) : _data(data), _offset(offset) {}
+
+            const UInt8* _data;
+            std::size_t _offset;
+
+            friend class LogFields;
+        };
+
+        LogFields() : _data(_inline), _size(0), _capacity(InlineSize), _count(0) {}
+        LogFields(std::initializer_list<LogField> fields);
+        LogFields(const LogFields& other);
+        LogFields(LogFields&& other) noexcept;
+        LogFields& operator=(const LogFields& other);
+        LogFields& operator=(LogFields&& other) noexcept;
+        ~LogFields();
+
+        void Add(const LogField& field);
+        void Add(std::initializer_list<LogField> fields);
+
+        template <typename T>
+        void Add(std::string_view key, const T& value) {
+            Add(LogField(key, value));
+        }
+
+        /// @brief Removes every field but keeps the buffer.
+        void Clear() {
+            _size = 0;
+            _count = 0;
+        }
+
+        /// @brief Removes every field and gives a heap buffer back.
+        void Reset();
+
+        Bool IsEmpty() const { return _count == 0; }
+        std::size_t GetCount() const { return _count; }
+
+        /// @brief Gets the number of bytes the buffer can hold before it has to grow.
+        std::size_t GetCapacity() const { return _capacity; }
+
+        Iterator begin() const { return Iterator(_data, 0); }
+        Iterator end() const { return Iterator(_data, _size); }
+
+    private:
+        UInt8* Grow(std::size_t size);
+        Bool IsInline() const { return _data == _inline; }
+
+        UInt8* _data;
+        std::size_t _size;
+        std::size_t _capacity;
+        std::size_t _count;
+        UInt8 _inline[InlineSize];
+    };
+
+}
+
+#endif
+#endif
@@ -0,0 +1,223 @@
+/// LogFormat.h
+/// --
+/// Deferred log formatting: arguments are packed on the calling thread and only turned
+/// into text on the logger thread.
+
+#pragma once
+
+#if defined(__cplusplus)
+#ifndef __MOCHI_LOG_FORMAT_H_HEADER_GUARD
+#define __MOCHI_LOG_FORMAT_H_HEADER_GUARD
+
+#include <Mochi/Core.h>
+#include <cstring>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// We are using parseInt("LogFormat", 31).toString(32)
+#define __MC_INTERNAL __Intrnl_gst8190r4__
+
+namespace MOCHI_NAMESPACE {
+
+    /// @brief The type tag written in front of every packed argument.
+    enum class LogArgumentType : UInt8 {
+        Int64, UInt64, Double, Bool, Char, String, Pointer
+    };
+
+    namespace __MC_INTERNAL {
+        // Not a constant expression on purpose: reaching it from the consteval constructor
+        // below turns a malformed format string into a compile error.
+        void InvalidLogFormatString(const char* reason);
+
+        consteval std::size_t CountLogFormatPlaceholders(std::string_view format) {
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < format.size(); i++) {
+                char c = format[i];
+                if (c == '{') {
+                    if (i + 1 < format.size() && format[i + 1] == '{') {
+                        i++;
+                    } else if (i + 1 < format.size() && format[i + 1] == '}') {
+                        count++;
+                        i++;
+                    } else {
+                        InvalidLogFormatString("Only '{}' placeholders are supported. Use '{{' for a literal brace.");
+                    }
+                } else if (c == '}') {
+                    if (i + 1 < format.size() && format[i + 1] == '}') {
+                        i++;
+                    } else {
+                        InvalidLogFormatString("Unmatched '}'. Use '}}' for a literal brace.");
+                    }
+                }
+            }
+
+            return count;
+        }
+    }
+
+    /// @brief A format string literal checked at compile time against the argument count.
+    ///
+    /// Only positional `{}` placeholders are supported; `{{` and `}}` produce literal braces.
+    /// The number of placeholders must match the number of arguments.
+    /// @tparam AllowTag Also accepts a placeholder-free literal followed by one string, which is
+    /// how `Logger::Info("text", "tag")` passed a tag before formatting existed.
+    template <Bool AllowTag, typename... TArgs>
+    class BasicLogFormatString {
+    public:
+        template <std::size_t N>
+        consteval BasicLogFormatString(const char (&format)[N]) : _format(format, N - 1), _isTagged(false) {
+            auto count = __MC_INTERNAL::CountLogFormatPlaceholders(_format);
+            if (count == sizeof...(TArgs)) return;
+            
+            if constexpr (AllowTag && sizeof...(TArgs) == 1) {
+                if (count == 0 && (std::is_convertible_v<const std::remove_cvref_t<TArgs>&, std::string_view> && ...)) {
+                    _isTagged = true;
+                    return;
+                }
+            }
+            
+            __MC_INTERNAL::InvalidLogFormatString("The number of '{}' placeholders does not match the number of arguments.");
+        }
+
+        constexpr std::string_view Get() const { return _format; }
+
+        /// @brief Whether this is plain text whose only argument is a tag.
+        constexpr Bool IsTagged() const { return _isTagged; }
+
+    private:
+        std::string_view _format;
+        Bool _isTagged;
+    };
+
+    template <typename... TArgs>
+    using LogFormatString = BasicLogFormatString<false, TArgs...>;
+
+    template <typename... TArgs>
+    using TaggedLogFormatString = BasicLogFormatString<true, TArgs...>;
+
+    /// @brief Packs log arguments into a self-describing byte buffer.
+    ///
+    /// Arithmetic values, characters, strings and pointers are copied as-is. Other types that
+    /// can be written to a `std::ostream` are converted to text on the calling thread.
+    class LogArguments {
+    public:
+        using Buffer = std::vector<UInt8>;
+
+        template <typename... TArgs>
+        static void Encode(Buffer& out, const TArgs&... args) {
+            (EncodeOne(out, args), ...);
+        }
+
+        /// @brief Replaces each `{}` in `format` with the next packed argument, appending to `out`.
+        static void Format(std::string_view format, std::span<const UInt8> arguments, std::string& out);
+
+        static void EncodeString(Buffer& out, std::string_view value);
+
+        /// @brief Hashes argument values the way they would be packed, so that arguments
+        /// producing the same message produce the same hash.
+        template <typename... TArgs>
+        static UInt64 Hash(const TArgs&... args) {
+            UInt64 hash = 0xcbf29ce484222325;
+            (HashOne(hash, args), ...);
+            return hash;
+        }
+
+    private:
+        static void HashBytes(UInt64& hash, LogArgumentType type, const void* data, std::size_t size);
+
+        template <typename T>
+        static void HashOne(UInt64& hash, const T& value) {
+            using TValue = std::remove_cvref_t<T>;
+
+            // Same types and tags as EncodeOne(), so values that format differently never collide
+            if constexpr (std::is_same_v<TValue, Bool>) {
+                UInt8 byte = value ? 1 : 0;
+                HashBytes(hash, LogArgumentType::Bool, &byte, sizeof(byte));
+            } else if constexpr (std::is_same_v<TValue, char>) {
+                HashBytes(hash, LogArgumentType::Char, &value, sizeof(value));
+            } else if constexpr (std::is_enum_v<TValue>) {
+                HashOne(hash, (std::underlying_type_t<TValue>) value);
+            } else if constexpr (std::is_integral_v<TValue> && std::is_signed_v<TValue>) {
+                auto wide = (Int64) value;
+                HashBytes(hash, LogArgumentType::Int64, &wide, sizeof(wide));
+            } else if constexpr (std::is_integral_v<TValue>) {
+                auto wide = (UInt64) value;
+                HashBytes(hash, LogArgumentType::UInt64, &wide, sizeof(wide));
+            } else if constexpr (std::is_floating_point_v<TValue>) {
+                auto wide = (double) value;
+                HashBytes(hash, LogArgumentType::Double, &wide, sizeof(wide));
+            } else if constexpr (std::is_null_pointer_v<TValue>) {
+                UInt64 address = 0;
+                HashBytes(hash, LogArgumentType::Pointer, &address, sizeof(address));
+            } else if constexpr (std::is_convertible_v<const TValue&, std::string_view>) {
+                std::string_view str;
+                if constexpr (std::is_pointer_v<TValue>) {
+                    str = value ? std::string_view(value) : std::string_view("(null)");
+                } else {
+                    str = value;
+                }
+
+                HashBytes(hash, LogArgumentType::String, str.data(), str.size());
+            } else if constexpr (std::is_pointer_v<TValue>) {
+                auto address = (UInt64) (std::uintptr_t) value;
+                HashBytes(hash, LogArgumentType::Pointer, &address, sizeof(address));
+            } else {
+                std::ostringstream str;
+                str << value;
+                auto text = str.str();
+                HashBytes(hash, LogArgumentType::String, text.data(), text.size());
+            }
+        }
+
+        template <typename T>
+        static void EncodeRaw(Buffer& out, LogArgumentType type, T value) {
+            auto offset = out.size();
+            out.resize(offset + 1 + sizeof(T));
+            out[offset] = (UInt8) type;
+            std::memcpy(out.data() + offset + 1, &value, sizeof(T));
+        }
+
+        template <typename T>
+        static void EncodeOne(Buffer& out, const T& value) {
+            using TValue = std::remove_cvref_t<T>;
+
+            if constexpr (std::is_same_v<TValue, Bool>) {
+                EncodeRaw<UInt8>(out, LogArgumentType::Bool, value ? 1 : 0);
+            } else if constexpr (std::is_same_v<TValue, char>) {
+                EncodeRaw<char>(out, LogArgumentType::Char, value);
+            } else if constexpr (std::is_enum_v<TValue>) {
+                EncodeOne(out, (std::underlying_type_t<TValue>) value);
+            } else if constexpr (std::is_integral_v<TValue> && std::is_signed_v<TValue>) {
+                EncodeRaw<Int64>(out, LogArgumentType::Int64, (Int64) value);
+            } else if constexpr (std::is_integral_v<TValue>) {
+                EncodeRaw<UInt64>(out, LogArgumentType::UInt64, (UInt64) value);
+            } else if constexpr (std::is_floating_point_v<TValue>) {
+                EncodeRaw<double>(out, LogArgumentType::Double, (double) value);
+            } else if constexpr (std::is_null_pointer_v<TValue>) {
+                EncodeRaw<UInt64>(out, LogArgumentType::Pointer, 0);
+            } else if constexpr (std::is_convertible_v<const TValue&, std::string_view>) {
+                if constexpr (std::is_pointer_v<TValue>) {
+                    EncodeString(out, value ? std::string_view(value) : std::string_view("(null)"));
+                } else {
+                    EncodeString(out, std::string_view(value));
+                }
+            } else if constexpr (std::is_pointer_v<TValue>) {
+                EncodeRaw<UInt64>(out, LogArgumentType::Pointer, (UInt64) (std::uintptr_t) value);
+            } else {
+                std::ostringstream str;
+                str << value;
+                EncodeString(out, str.str());
+            }
+        }
+    };
+
+}
+
+#undef __MC_INTERNAL
+
+#endif
+#endif
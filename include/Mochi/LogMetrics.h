@@ -0,0 +1,97 @@
+/// LogMetrics.h
+/// --
+/// Counters and histograms the logger keeps about itself. Everything here is written by a
+/// single thread and can be read from any thread without locking.
+
+#pragma once
+
+#if defined(__cplusplus)
+#ifndef __MOCHI_LOG_METRICS_H_HEADER_GUARD
+#define __MOCHI_LOG_METRICS_H_HEADER_GUARD
+
+#include <Mochi/Core.h>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+
+namespace MOCHI_NAMESPACE {
+
+    /// @brief An HDR-style log-linear histogram of non-negative values, e.g. nanoseconds.
+    ///
+    /// Values are grouped by powers of two, and each power of two is split into
+    /// `SubBucketCount` linear buckets, so any recorded value is reported within about
+    /// 6% of its true value across the whole 64-bit range, in a fixed table of about 8 KiB.
+    /// Only one thread may record; any thread may read.
+    class LatencyHistogram {
+    public:
+        static constexpr UInt32 SubBucketBits = 4;
+        static constexpr UInt32 SubBucketCount = 1u << SubBucketBits;
+        static constexpr UInt32 BucketCount = (64 - SubBucketBits + 1) * SubBucketCount;
+
+        LatencyHistogram();
+
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        void Record(UInt64 value) {
+            auto &bucket = _counts[GetBucketIndex(value)];
+            bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            _count.store(_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            _sum.store(_sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            if (value > _max.load(std::memory_order_relaxed)) _max.store(value, std::memory_order_relaxed);
+        }
+
+        UInt64 GetCount() const { return _count.load(std::memory_order_relaxed); }
+        UInt64 GetMax() const { return _max.load(std::memory_order_relaxed); }
+        double GetMean() const;
+
+        /// @brief Gets the value below which `percentile` percent of the recorded values fall.
+        /// The result is the upper bound of the bucket it falls in, capped at `GetMax()`.
+        UInt64 GetValueAtPercentile(double percentile) const;
+
+        UInt64 GetBucketCount(UInt32 index) const { return _counts[index].load(std::memory_order_relaxed); }
+
+        static UInt32 GetBucketIndex(UInt64 value) {
+            if (value < SubBucketCount) return (UInt32) value;
+
+            auto shift = (UInt32) std::bit_width(value) - 1 - SubBucketBits;
+            auto sub = (UInt32) (value >> shift) & (SubBucketCount - 1);
+            return (shift + 1) * SubBucketCount + sub;
+        }
+
+        /// @brief Gets the largest value that falls in the bucket at `index`.
+        static UInt64 GetBucketUpperBound(UInt32 index);
+
+    private:
+        std::atomic<UInt64> _counts[BucketCount];
+        std::atomic<UInt64> _count;
+        std::atomic<UInt64> _sum;
+        std::atomic<UInt64> _max;
+    };
+
+    /// @brief Time spent in one handler. Only the thread running the handler records.
+    class LogSinkMetrics {
+    public:
+        void Record(std::size_t events, UInt64 nanos) {
+            _batches.store(_batches.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            _events.store(_events.load(std::memory_order_relaxed) + events, std::memory_order_relaxed);
+            _totalNanos.store(_totalNanos.load(std::memory_order_relaxed) + nanos, std::memory_order_relaxed);
+            if (nanos > _maxNanos.load(std::memory_order_relaxed)) _maxNanos.store(nanos, std::memory_order_relaxed);
+        }
+
+        UInt64 GetBatches() const { return _batches.load(std::memory_order_relaxed); }
+        UInt64 GetEvents() const { return _events.load(std::memory_order_relaxed); }
+        UInt64 GetTotalNanos() const { return _totalNanos.load(std::memory_order_relaxed); }
+        UInt64 GetMaxNanos() const { return _maxNanos.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<UInt64> _batches = 0;
+        std::atomic<UInt64> _events = 0;
+        std::atomic<UInt64> _totalNanos = 0;
+        std::atomic<UInt64> _maxNanos = 0;
+    };
+
+}
+
+#endif
+#endif
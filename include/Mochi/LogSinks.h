@@ -0,0 +1,271 @@
+/// LogSinks.h
+/// --
+/// Built-in sinks that can be registered with `Logger::AddLoggedListener()`.
+
+#pragma once
+
+#if defined(__cplusplus)
+#ifndef __MOCHI_LOG_SINKS_H_HEADER_GUARD
+#define __MOCHI_LOG_SINKS_H_HEADER_GUARD
+
+#include <Mochi/Logging.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace MOCHI_NAMESPACE {
+
+    /// @brief The kinds of records found in a binary log file.
+    enum class BinaryLogRecordKind : UInt8 {
+        /// @brief Assigns an ID to a tag name. Written before the first event using the tag.
+        Tag = 1,
+
+        /// @brief Assigns an ID to a thread. Written before the first event from the thread.
+        Thread = 2,
+
+        /// @brief A log event.
+        Event = 3
+    };
+
+    /// @brief Writes events as compact binary records, to be turned back into text offline
+    /// with `BinaryLogDecoder` (or the `Mochi-logdecode` tool).
+    ///
+    /// The file starts with `Magic` and `Version`. Every record is prefixed with its length as
+    /// a varint, followed by its kind. Events store the timestamp as a zigzag varint delta in
+    /// microseconds from the previous event, the level, interned tag and thread IDs and the
+    /// UTF-8 text of the message. Events with fields append their count, then the key, type and
+    /// value of each field; readers that predate fields ignore them. The sink must only be
+    /// invoked from the logger thread.
+    class BinaryLogSink : public IAsyncLogEventDelegate {
+    public:
+        using Ref = Handle<BinaryLogSink>;
+
+        static constexpr char Magic[8] = { 'M', 'O', 'C', 'H', 'I', 'L', 'O', 'G' };
+        static constexpr UInt8 Version = 1;
+
+        /// @brief Creates (or truncates) the file at `path`.
+        explicit BinaryLogSink(const std::string& path);
+        ~BinaryLogSink();
+
+        std::future<void> Invoke(Handle<LoggerEventArgs> ev) override;
+        std::future<void> InvokeBatch(LoggerEventBatch events) override;
+
+        /// @brief Writes out everything buffered so far.
+        std::future<void> Flush() override;
+
+    private:
+        struct StringHash {
+            using is_transparent = void;
+            std::size_t operator()(std::string_view str) const { return std::hash<std::string_view>()(str); }
+        };
+
+        using TagTable    = std::unordered_map<std::string, UInt32, StringHash, std::equal_to<>>;
+        using ThreadTable = std::unordered_map<std::thread::id, UInt32>;
+
+        void Encode(const LoggerEventArgs& ev);
+        void EncodeFields(const LogFields& fields);
+        UInt32 InternTag(std::string_view tag);
+        UInt32 InternThread(std::thread::id id);
+        void BeginRecord(BinaryLogRecordKind kind);
+        void EndRecord();
+
+        std::ofstream _stream;
+        std::string _buffer;
+        std::string _record;
+        std::string _text;
+        TagTable _tags;
+        ThreadTable _threads;
+        
+        /// @brief File tag IDs by `LogTags` ID, so interned tags are never flattened twice.
+        std::vector<UInt32> _internedTags;
+        Int64 _lastTimestamp;
+    };
+
+    /// @brief When `FileLogSink` asks the OS to commit written data to disk.
+    enum class FileSyncPolicy {
+        /// @brief Leaves it to the OS.
+        Never,
+
+        /// @brief Syncs a file before it is rotated or closed.
+        OnRotate,
+
+        /// @brief Also syncs on every `Flush()`, i.e. on `Logger::FlushAsync()`.
+        OnFlush,
+
+        /// @brief Syncs after every write. Slowest, but nothing written is lost on power failure.
+        EveryWrite
+    };
+
+    /// @brief The line format written by `FileLogSink`.
+    enum class FileLogFormat {
+        /// @brief `2024-01-01 12:00:00.000 [Thread@1] [Info] [Tag] text key=value ...`
+        Text,
+
+        /// @brief One JSON object per line with `timestamp` (Unix microseconds), `level`,
+        /// `tag`, `thread` and `message`, plus a `fields` object if the event has any.
+        JsonLines
+    };
+
+    struct FileLogSinkOptions {
+        /// @brief The file being written. Rotated files get `.1`, `.2`, ... appended.
+        std::string path;
+
+        FileLogFormat format = FileLogFormat::Text;
+
+        /// @brief Buffered bytes that trigger a write.
+        std::size_t bufferSize = 1024 * 1024;
+
+        /// @brief Maximum age of buffered data. The writer thread keeps track of it on its own,
+        /// so the data is written out on time even if no further events arrive.
+        std::chrono::milliseconds flushInterval = std::chrono::milliseconds(1000);
+
+        /// @brief Events at or above this level are written out by the end of their batch.
+        LogLevel flushLevel = LogLevel::Error;
+
+        /// @brief Rotates before the file grows past this many bytes. `0` disables it.
+        std::size_t maxFileSize = 0;
+
+        /// @brief Rotates once the file has been open this long. `0` disables it.
+        std::chrono::seconds rotateInterval = std::chrono::seconds(0);
+
+        /// @brief The number of rotated files kept next to the active one.
+        UInt32 maxFiles = 5;
+
+        FileSyncPolicy syncPolicy = FileSyncPolicy::OnRotate;
+    };
+
+    /// @brief Appends events to a file through a large userspace buffer.
+    ///
+    /// Lines are formatted on the calling thread into fixed-size chunks. The buffer is handed to
+    /// a writer thread of the sink, which writes it with one `writev()`, when it fills up, when
+    /// buffered data gets older than the flush interval, when an event reaches the flush level
+    /// and on `Logger::FlushAsync()`. Rotating and syncing the file happen on the writer thread
+    /// too, so neither producers nor the other handlers on the logger thread wait for the disk.
+    /// Write errors are reported by the next call to the sink.
+    class FileLogSink : public IAsyncLogEventDelegate {
+    public:
+        using Ref = Handle<FileLogSink>;
+
+        /// @brief The size of each buffer chunk, i.e. of each `iovec` handed to `writev()`.
+        static constexpr std::size_t ChunkSize = 64 * 1024;
+
+        /// @brief Buffers handed to the writer thread that it has yet to write. Once it falls
+        /// this far behind, the thread logging waits for it.
+        static constexpr std::size_t MaxPendingBuffers = 4;
+
+        explicit FileLogSink(FileLogSinkOptions options);
+        explicit FileLogSink(const std::string& path);
+        ~FileLogSink();
+
+        FileLogSink(const FileLogSink&) = delete;
+        FileLogSink& operator=(const FileLogSink&) = delete;
+
+        std::future<void> Invoke(Handle<LoggerEventArgs> ev) override;
+        std::future<void> InvokeBatch(LoggerEventBatch events) override;
+
+        /// @brief Hands the buffer to the writer thread. The future completes once it is written.
+        std::future<void> Flush() override;
+
+        /// @brief Starts a new file after the lines buffered so far. The writer thread does the
+        /// renaming, so this does not wait for it. Only call this from the thread the sink runs on.
+        void Rotate();
+
+        const FileLogSinkOptions& GetOptions() const { return _options; }
+
+    private:
+        using SteadyTime = std::chrono::steady_clock::time_point;
+        using Chunks = std::vector<std::string>;
+
+        /// @brief Buffered lines handed to the writer thread.
+        struct PendingBuffer {
+            Chunks chunks;
+
+            /// @brief Starts a new file once the lines are written.
+            Bool rotate = false;
+            Bool sync = false;
+            Handle<std::promise<void>> written;
+        };
+
+        void Open();
+        void Close();
+        void Sync();
+        void RotateFile();
+        void Append(const LoggerEventArgs& ev, SteadyTime now, std::unique_lock<std::mutex>& lock);
+        void FormatText(const LoggerEventArgs& ev);
+        void FormatJson(const LoggerEventArgs& ev);
+        const std::string& GetThreadName(std::thread::id id);
+        void Submit(std::unique_lock<std::mutex>& lock, Bool rotate,
+                    Bool sync = false, Handle<std::promise<void>> written = nullptr);
+        void HandOff(Bool rotate, Bool sync, Handle<std::promise<void>> written);
+        void HandOffExpired(SteadyTime now);
+        void ThrowPendingError();
+        void RunWriter();
+        void Write(Chunks& chunks);
+
+        FileLogSinkOptions _options;
+        std::string _line;
+        std::string _text;
+        TimestampFormatter _timestamps;
+        std::unordered_map<std::thread::id, std::string> _threadNames;
+
+        // Shared with the writer thread, guarded by _mutex
+        std::mutex _mutex;
+        std::condition_variable _wakeWriter;
+        std::condition_variable _bufferWritten;
+        Chunks _chunks;
+        std::size_t _chunkIndex;
+        std::size_t _buffered;
+        SteadyTime _bufferedSince;
+
+        /// @brief The bytes handed off for the current file, whether or not they are written yet.
+        std::size_t _fileSize;
+        SteadyTime _openedAt;
+        std::deque<PendingBuffer> _pending;
+        std::vector<Chunks> _spareChunks;
+        std::string _error;
+        Bool _isRunning;
+
+        // Only touched by the writer thread once it is running
+        int _fd;
+        std::thread _writer;
+    };
+
+    /// @brief An event read back from a binary log file.
+    struct DecodedLogRecord {
+        LogLevel level;
+        std::chrono::time_point<std::chrono::system_clock> timestamp;
+        std::string tag;
+        std::string thread;
+        std::string text;
+        LogFields fields;
+    };
+
+    /// @brief Reads the files written by `BinaryLogSink`.
+    class BinaryLogDecoder {
+    public:
+        /// @brief Checks the file header. Throws if the stream is not a binary log.
+        explicit BinaryLogDecoder(std::istream& stream);
+
+        /// @brief Reads the next event, handling tag and thread records along the way.
+        /// @return `false` at the end of the stream. Throws on corrupted records.
+        Bool Next(DecodedLogRecord& out);
+
+    private:
+        std::istream& _stream;
+        std::string _record;
+        std::unordered_map<UInt32, std::string> _tags;
+        std::unordered_map<UInt32, std::string> _threads;
+        Int64 _lastTimestamp;
+    };
+
+}
+
+#endif
+#endif
@@ -0,0 +1,139 @@
+/// LogTask.h
+/// --
+/// Log handlers written as coroutines.
+
+#pragma once
+
+#if defined(__cplusplus)
+#ifndef __MOCHI_LOG_TASK_H_HEADER_GUARD
+#define __MOCHI_LOG_TASK_H_HEADER_GUARD
+
+#include <Mochi/Logging.h>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <functional>
+
+namespace MOCHI_NAMESPACE {
+
+    /// @brief The return type of a coroutine log handler.
+    ///
+    /// The coroutine starts running as soon as it is called, on the thread delivering the
+    /// event, and keeps running in the background if it suspends. Frames are recycled by the
+    /// thread that allocated them, so once a handler has run a few times calling it allocates nothing.
+    ///
+    ///     LogTask OnLogged(Handle<LoggerEventArgs> ev) {
+    ///         co_await socket.WriteAsync(Render(*ev));
+    ///     }
+    class LogTask {
+    public:
+        class promise_type {
+        public:
+            LogTask get_return_object() {
+                return LogTask(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_never initial_suspend() noexcept { return {}; }
+
+            auto final_suspend() noexcept {
+                struct FinalAwaiter {
+                    Bool await_ready() const noexcept { return false; }
+                    void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                        LogTask::Finish(handle);
+                    }
+                    void await_resume() const noexcept {}
+                };
+
+                return FinalAwaiter {};
+            }
+
+            void return_void() {}
+            void unhandled_exception();
+
+            static void* operator new(std::size_t size);
+            static void operator delete(void* frame, std::size_t size);
+
+        private:
+            std::atomic<UInt8> _state = Running;
+            std::atomic<std::size_t>* _pending = nullptr;
+
+            friend class LogTask;
+        };
+
+        LogTask(LogTask&& other) noexcept : _handle(other._handle) {
+            other._handle = nullptr;
+        }
+
+        LogTask(const LogTask&) = delete;
+        LogTask& operator=(const LogTask&) = delete;
+
+        /// @brief Lets the coroutine finish on its own if it has not already.
+        ~LogTask() {
+            Detach(nullptr);
+        }
+
+        Bool IsDone() const {
+            return !_handle || _handle.done();
+        }
+
+        /// @brief Gives up the coroutine. If it is still running, `pending` is incremented now
+        /// and decremented (then notified) once the coroutine finishes.
+        void Detach(std::atomic<std::size_t>* pending);
+
+    private:
+        // Whoever of the owner and the coroutine gets to the end second destroys the frame
+        static constexpr UInt8 Running = 0;
+        static constexpr UInt8 Detached = 1;
+        static constexpr UInt8 Done = 2;
+
+        explicit LogTask(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+        static void Finish(std::coroutine_handle<promise_type> handle) noexcept;
+        static void Release(std::atomic<std::size_t>* pending) noexcept;
+
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    /// @brief Adapts coroutine handlers to `IAsyncLogEventDelegate`.
+    ///
+    /// The logger starts one coroutine per event (or per batch) and does not wait for it, so
+    /// no promise or future is made per event. `Flush()` waits until every coroutine that was
+    /// still suspended has finished.
+    class LogTaskDelegate : public IAsyncLogEventDelegate {
+    public:
+        using Signature = std::function<LogTask(Handle<LoggerEventArgs>)>;
+
+        /// @brief The span is only valid until the coroutine first suspends; copy the events
+        /// you still need before that.
+        using BatchSignature = std::function<LogTask(LoggerEventBatch)>;
+
+        static Handle<IAsyncLogEventDelegate> Create(Signature handler);
+        static Handle<IAsyncLogEventDelegate> CreateBatched(BatchSignature handler);
+
+        /// @brief Runs the handler and waits for every unfinished coroutine, this one included.
+        std::future<void> Invoke(Handle<LoggerEventArgs> ev) override;
+        std::future<void> InvokeBatch(LoggerEventBatch events) override;
+
+        void Deliver(LoggerEventBatch events) override;
+        std::future<void> Flush() override;
+
+        /// @brief Gets the number of coroutines that suspended and have not finished yet.
+        std::size_t GetPendingCount() const {
+            return _pending.load(std::memory_order_acquire);
+        }
+
+    private:
+        LogTaskDelegate(Signature handler, BatchSignature batchHandler)
+        : _handler(std::move(handler)), _batchHandler(std::move(batchHandler)), _pending(0) {}
+
+        void WaitPending();
+
+        Signature _handler;
+        BatchSignature _batchHandler;
+        std::atomic<std::size_t> _pending;
+    };
+
+}
+
+#endif
+#endif
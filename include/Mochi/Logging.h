@@ -10,9 +10,19 @@
 #define __MOCHI_LOGGING_H_HEADER_GUARD
 
 #include <Mochi/Components.h>
+#include <Mochi/Concurrent.h>
+#include <Mochi/LogFormat.h>
+#include <Mochi/LogFields.h>
+#include <Mochi/LogClock.h>
+#include <Mochi/LogMetrics.h>
+#include <algorithm>
 #include <ctime>
 #include <iostream>
+#include <mutex>
 #include <chrono>
+#include <coroutine>
+#include <span>
+#include <source_location>
 
 namespace MOCHI_NAMESPACE {
 
@@ -22,6 +32,10 @@ namespace MOCHI_NAMESPACE {
 
     std::string GetLogLevelName(LogLevel level);
     bool GetLogLevelName(LogLevel level, std::string *outName);
+    TextColor::Ref GetLogLevelColor(LogLevel level);
+
+    class LogCallSite;
+    class LogCrashRing;
 
     struct LoggerEventArgs {
         LogLevel level;
@@ -30,66 +44,1129 @@ namespace MOCHI_NAMESPACE {
         Handle<TextColor> color;
         std::thread::id threadId;
         std::chrono::time_point<std::chrono::system_clock> timestamp;
+        
+        /// @brief The statement that produced this event, or `nullptr` if it was not logged
+        /// through the `MOCHI_LOG_*` macros.
+        const LogCallSite* site = nullptr;
+        
+        /// @brief Structured data logged next to the message. See `Logger::LogStructured()`.
+        LogFields fields;
+        
+        /// @brief The ID of `tag` in `LogTags`, or 0 if the tag was not interned.
+        UInt32 tagId = 0;
+    };
+
+    /// @brief The constant part of a log statement: its level, tag, format and location.
+    ///
+    /// The `MOCHI_LOG_*` macros keep one of these in a `constinit` static per statement, and
+    /// register it in `LogCallSites` the first time the statement runs. Events logged through a
+    /// call site only carry a pointer to it plus the packed arguments; the level color, tag
+    /// text and format string are filled in on the logger thread.
+    class LogCallSite {
+    public:
+        constexpr LogCallSite(LogLevel level,
+                              std::string_view tag,
+                              std::source_location location = std::source_location::current())
+        : level(level), tag(tag), location(location), _format(), _id(0) {}
+        
+        LogCallSite(const LogCallSite&) = delete;
+        LogCallSite& operator=(const LogCallSite&) = delete;
+        
+        const LogLevel level;
+        const std::string_view tag;
+        const std::source_location location;
+        
+        /// @brief Gets the registry ID of this site, or 0 if it has not been registered yet.
+        UInt32 GetId() const { return _id.load(std::memory_order_acquire); }
+        std::string_view GetFormat() const { return _format; }
+        
+        /// @brief Registers the site with its format string, unless that already happened.
+        void Bind(std::string_view format);
+        
+    private:
+        std::string_view _format;
+        std::atomic<UInt32> _id;
+        
+        friend class LogCallSites;
+    };
+
+    /// @brief The process-wide table of registered `LogCallSite`s, indexed by their IDs.
+    class LogCallSites {
+    public:
+        static UInt32 Register(LogCallSite& site, std::string_view format);
+        
+        /// @brief Looks up a site by ID. Returns `nullptr` for unknown IDs.
+        static const LogCallSite* Get(UInt32 id);
+        static std::vector<const LogCallSite*> GetAll();
+    };
+
+    /// @brief A tag component built once and shared by every event logged with it.
+    /// The component must not be mutated once it has been handed out.
+    struct LogTag {
+        IComponent::Ref component;
+        UInt32 id = 0;
+    };
+
+    /// @brief The process-wide table of interned tags, indexed by their IDs.
+    ///
+    /// Interning the same name twice returns the same component, so every `NamedLogger` with
+    /// that name shares it, and sinks can key their own per-tag state on the ID instead of
+    /// flattening and hashing the tag of every event.
+    class LogTags {
+    public:
+        /// @brief Gets the tag for `name`, creating it on first use. Takes a lock, so intern
+        /// tags once and keep them.
+        static LogTag Intern(std::string_view name);
+        
+        /// @brief Looks up a tag by ID. Returns an empty tag for unknown IDs.
+        static LogTag Get(UInt32 id);
+    };
+
+    /// @brief A lock-free token bucket, kept per statement by the `MOCHI_LOG_LIMITED` macros.
+    ///
+    /// Implemented as GCRA: a single atomic holds the time at which the bucket would be full
+    /// again, so taking a token is one clock read and one CAS. Rejected calls are only counted,
+    /// and the count is handed to the next call that gets through.
+    class LogRateLimiter {
+    public:
+        /// @param perSecond The sustained number of events let through per second. A rate of
+        /// zero (or less) lets nothing through.
+        /// @param burst The number of events let through back to back after a quiet period.
+        constexpr LogRateLimiter(double perSecond, UInt32 burst = 1)
+        : _isClosed(!(perSecond > 0)),
+          _interval(perSecond > 0 ? (UInt64) (1e9 / perSecond) : 0),
+          _tolerance(perSecond > 0 ? (UInt64) (1e9 / perSecond) * (burst > 0 ? burst - 1 : 0) : 0),
+          _readyAt(0), _suppressed(0) {}
+        
+        LogRateLimiter(const LogRateLimiter&) = delete;
+        LogRateLimiter& operator=(const LogRateLimiter&) = delete;
+        
+        /// @brief Takes a token if there is one.
+        /// @param suppressed Receives the number of calls rejected since the last successful one.
+        Bool TryAcquire(UInt64& suppressed) {
+            if (_isClosed) {
+                _suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            
+            auto now = GetSteadyNanos();
+            auto readyAt = _readyAt.load(std::memory_order_relaxed);
+            
+            for (;;) {
+                auto base = std::max(readyAt, now);
+                if (base - now > _tolerance) {
+                    _suppressed.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                
+                if (_readyAt.compare_exchange_weak(readyAt, base + _interval, std::memory_order_relaxed)) break;
+            }
+            
+            suppressed = _suppressed.load(std::memory_order_relaxed) == 0 ? 0 : _suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+        
+        static UInt64 GetSteadyNanos() {
+            return (UInt64) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+        
+    private:
+        const Bool _isClosed;
+        const UInt64 _interval;
+        const UInt64 _tolerance;
+        std::atomic<UInt64> _readyAt;
+        std::atomic<UInt64> _suppressed;
+    };
+
+    /// @brief Drops repeats of the same message within a time window, kept per statement by
+    /// the `MOCHI_LOG_DEDUP` macros.
+    ///
+    /// Messages are told apart by a hash of their arguments and tracked in a small direct-mapped
+    /// table, so two different messages landing in the same slot simply take turns.
+    class LogDeduplicator {
+    public:
+        static constexpr std::size_t SlotCount = 16;
+        
+        constexpr LogDeduplicator(std::chrono::milliseconds window)
+        : _window((UInt64) window.count() * 1000000), _slots() {}
+        
+        LogDeduplicator(const LogDeduplicator&) = delete;
+        LogDeduplicator& operator=(const LogDeduplicator&) = delete;
+        
+        /// @brief Lets the message with `hash` through unless it was seen within the window.
+        /// @param suppressed Receives the number of repeats dropped in its slot since the last message let through.
+        Bool TryAcquire(UInt64 hash, UInt64& suppressed) {
+            auto now = LogRateLimiter::GetSteadyNanos();
+            auto &slot = _slots[hash % SlotCount];
+            auto expiresAt = slot.expiresAt.load(std::memory_order_relaxed);
+            
+            for (;;) {
+                if (slot.hash.load(std::memory_order_relaxed) == hash && now < expiresAt) {
+                    slot.suppressed.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                
+                if (slot.expiresAt.compare_exchange_weak(expiresAt, now + _window, std::memory_order_relaxed)) break;
+            }
+            
+            slot.hash.store(hash, std::memory_order_relaxed);
+            suppressed = slot.suppressed.load(std::memory_order_relaxed) == 0 ? 0 : slot.suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+        
+    private:
+        struct Slot {
+            std::atomic<UInt64> hash = 0;
+            std::atomic<UInt64> expiresAt = 0;
+            std::atomic<UInt64> suppressed = 0;
+        };
+        
+        const UInt64 _window;
+        Slot _slots[SlotCount];
     };
 
+    using LoggerEventBatch = std::span<const Handle<LoggerEventArgs>>;
+
     class IAsyncLogEventDelegate {
-        using Signature = std::function<std::future<void>(Handle<LoggerEventArgs>)>;;
+        using Signature = std::function<std::future<void>(Handle<LoggerEventArgs>)>;
+        using BatchSignature = std::function<std::future<void>(LoggerEventBatch)>;
         
     public:
         virtual std::future<void> Invoke(Handle<LoggerEventArgs> ev) = 0;
+        
+        /// @brief Handles a run of consecutive events in one call.
+        /// The default implementation calls `Invoke()` for each event. Override this to let
+        /// a sink do one write per batch. The span is only valid for the duration of the call.
+        virtual std::future<void> InvokeBatch(LoggerEventBatch events);
+        
+        /// @brief Hands events to the handler when nobody is going to wait for them, which is
+        /// how the logger itself calls handlers. The default implementation calls `Invoke()` for
+        /// a single event and `InvokeBatch()` otherwise, and drops the future. Override this to
+        /// skip making a future per call.
+        virtual void Deliver(LoggerEventBatch events);
+        
+        /// @brief Writes out anything the handler buffered. Called by `Logger::FlushAsync()`
+        /// once every earlier event has been handed to the handler.
+        virtual std::future<void> Flush();
+        
         static Handle<IAsyncLogEventDelegate> Create(Signature delegate);
+        static Handle<IAsyncLogEventDelegate> CreateBatched(BatchSignature delegate);
     };
 
-    class Logger {
+    /// @brief Recycles `LoggerEventArgs` together with the literal components holding their text.
+    ///
+    /// Each pooled event owns a content and a tag component. Acquiring an event overwrites their
+    /// text in place, so once the pool is warm a text event costs no allocation as long as the
+    /// string fits in the capacity left by earlier messages. Events are only taken back when no
+    /// handler kept a reference to them or to their components.
+    class LoggerEventPool {
+    public:
+        /// @brief Text buffers grown beyond this many bytes are released instead of being kept.
+        static constexpr std::size_t MaxRetainedTextSize = 4096;
+        
+        explicit LoggerEventPool(std::size_t capacity);
+        
+        /// @brief Takes an event out of the pool, or creates one if the pool is empty.
+        Handle<LoggerEventArgs> Acquire(LogLevel level,
+                                        std::string_view text,
+                                        Handle<TextColor> color,
+                                        std::string_view tag);
+        
+        /// @brief Takes an event that shares an interned tag instead of copying its text.
+        Handle<LoggerEventArgs> Acquire(LogLevel level,
+                                        std::string_view text,
+                                        Handle<TextColor> color,
+                                        const LogTag& tag);
+        
+        /// @brief Takes an event whose text is formatted later by `FormatPending()`.
+        /// Only the arguments are copied here; `format` must outlive the event (a literal).
+        template <typename... TArgs>
+        Handle<LoggerEventArgs> AcquireFormatted(LogLevel level,
+                                                 Handle<TextColor> color,
+                                                 std::string_view tag,
+                                                 std::string_view format,
+                                                 const TArgs&... args) {
+            auto entry = TakeEntry(level, std::move(color));
+            entry->tagText->text.assign(tag);
+            entry->format = format;
+            entry->hasPendingFormat = true;
+            LogArguments::Encode(entry->arguments, args...);
+            return entry;
+        }
+        
+        template <typename... TArgs>
+        Handle<LoggerEventArgs> AcquireFormatted(LogLevel level,
+                                                 Handle<TextColor> color,
+                                                 const LogTag& tag,
+                                                 std::string_view format,
+                                                 const TArgs&... args) {
+            auto entry = TakeEntry(level, std::move(color));
+            entry->tag = tag.component;
+            entry->tagId = tag.id;
+            entry->format = format;
+            entry->hasPendingFormat = true;
+            LogArguments::Encode(entry->arguments, args...);
+            return entry;
+        }
+        
+        /// @brief Takes an event for a call site. Only the arguments are copied here.
+        /// @param tag Overrides the tag of the site, or `nullptr` to use the site's own tag.
+        template <typename... TArgs>
+        Handle<LoggerEventArgs> AcquireSite(const LogCallSite& site,
+                                            const LogTag* tag,
+                                            const TArgs&... args) {
+            auto entry = TakeEntry(site.level, nullptr);
+            entry->site = &site;
+            entry->hasTagOverride = tag != nullptr;
+            if (tag) {
+                entry->tag = tag->component;
+                entry->tagId = tag->id;
+            }
+            entry->hasPendingFormat = true;
+            LogArguments::Encode(entry->arguments, args...);
+            return entry;
+        }
+        
+        /// @brief Fills in what producers deferred: the text of an event obtained from
+        /// `AcquireFormatted()`, and the color, tag and format of an event obtained from
+        /// `AcquireSite()`. Does nothing for other events. Called on the logger thread.
+        void FormatPending(const Handle<LoggerEventArgs>& event);
+        
+        /// @brief Takes an event whose content and tag are supplied by the caller.
+        Handle<LoggerEventArgs> Acquire(LogLevel level,
+                                        Handle<IComponent> content,
+                                        Handle<TextColor> color,
+                                        Handle<IComponent> tag);
+        
+        /// @brief Hands an event obtained from `Acquire()` back to the pool. `event` is reset.
+        /// Safe to call from any thread, e.g. from a producer dropping an event the logger thread
+        /// never saw: the event is only recycled if `event` was the last reference to it and to
+        /// its components, and the free list is lock-free.
+        void Release(Handle<LoggerEventArgs>& event);
+        
+    private:
+        struct Entry : public LoggerEventArgs {
+            IComponent::Ref ownContent;
+            IComponent::Ref ownTag;
+            LiteralContent::Ref contentText;
+            LiteralContent::Ref tagText;
+            std::string_view format;
+            LogArguments::Buffer arguments;
+            Bool hasPendingFormat = false;
+            Bool hasTagOverride = false;
+        };
+        
+        Handle<Entry> TakeEntry(LogLevel level, Handle<TextColor> color);
+        
+        friend class LogCrashRing;
+        friend class LogPipeline;
+        static Handle<Entry> CreateEntry();
+        static void ResetText(std::string& text);
+        
+        ConcurrentRingBuffer<Handle<Entry>> _free;
+    };
+
+    /// @brief Where a registered handler runs.
+    enum class LogSinkDispatch {
+        /// @brief On the logger thread, one handler after another.
+        LoggerThread,
+
+        /// @brief On a worker thread of its own, fed through its own queue. A slow handler then
+        /// only delays itself, and every handler still sees the events in order.
+        Dedicated
+    };
+
+    /// @brief Runs one handler on its own thread for `LogSinkDispatch::Dedicated`.
+    ///
+    /// The logger thread posts events after formatting them and keeps them out of the pool
+    /// until the worker dropped its reference. When the worker queue is full, the logger
+    /// thread waits for it, so a stalled handler eventually pushes back on producers through
+    /// the logger queue instead of growing without bounds.
+    class LogSinkWorker {
+    public:
+        static constexpr std::size_t QueueCapacity = 8192;
+        static constexpr std::size_t MaxBatchSize = 256;
+
+        explicit LogSinkWorker(Handle<IAsyncLogEventDelegate> handler,
+                               Handle<LogSinkMetrics> metrics = CreateRef<LogSinkMetrics>());
+        ~LogSinkWorker();
+
+        LogSinkWorker(const LogSinkWorker&) = delete;
+        LogSinkWorker& operator=(const LogSinkWorker&) = delete;
+
+        const Handle<IAsyncLogEventDelegate>& GetHandler() const { return _handler; }
+        const Handle<LogSinkMetrics>& GetMetrics() const { return _metrics; }
+        std::size_t GetQueueDepth() const { return _queue.GetSize(); }
+
+        void Post(Handle<LoggerEventArgs> event);
+
+        /// @brief Flushes the handler after every event posted so far, then calls `done` on the worker.
+        void PostFlush(std::function<void()> done);
+
+        /// @brief Handles everything still queued, then stops the worker.
+        void Stop();
+
+    private:
+        struct Record {
+            Handle<LoggerEventArgs> event;
+            std::function<void()> action;
+        };
+
+        void Run();
+        void Post(Record record);
+        void InvokeBatch();
+
+        Handle<IAsyncLogEventDelegate> _handler;
+        Handle<LogSinkMetrics> _metrics;
+        ConcurrentRingBuffer<Record> _queue;
+        IdleWaiter _idleWaiter;
+        std::atomic<Bool> _isRunning;
+        std::vector<Handle<LoggerEventArgs>> _batch;
+        std::thread _thread;
+    };
+
+    /// @brief Handler statistics, as returned by `Logger::GetMetrics()`.
+    struct LogSinkMetricsSnapshot {
+        Handle<IAsyncLogEventDelegate> handler;
+        LogSinkDispatch dispatch;
+        UInt64 batches;
+        UInt64 events;
+        std::chrono::nanoseconds totalTime;
+        std::chrono::nanoseconds maxBatchTime;
+        
+        /// @brief Events waiting in the worker queue. Always `0` on the logger thread.
+        std::size_t queueDepth;
+    };
+
+    /// @brief A snapshot of the logger's own counters.
+    struct LoggerMetrics {
+        std::size_t queueCapacity;
+        std::size_t queueDepth;
+        
+        /// @brief The deepest backlog the logger thread has found when polling.
+        std::size_t queueHighWater;
+        
+        /// @brief Records accepted by the queue, including `FlushAsync()` hooks.
+        UInt64 enqueued;
+        UInt64 dispatched;
+        UInt64 dropped;
+        
+        /// @brief Time from `LoggerEventArgs::timestamp` to the hand-off to the handlers.
+        UInt64 latencySamples;
+        std::chrono::nanoseconds latencyMean;
+        std::chrono::nanoseconds latencyP50;
+        std::chrono::nanoseconds latencyP90;
+        std::chrono::nanoseconds latencyP99;
+        std::chrono::nanoseconds latencyP999;
+        std::chrono::nanoseconds latencyMax;
+        
+        std::vector<LogSinkMetricsSnapshot> sinks;
+    };
+
+    /// @brief What producers do when the logger queue is full.
+    enum class QueueFullPolicy {
+        /// @brief Waits for the logger thread to free up a cell. Nothing is lost.
+        Block,
+
+        /// @brief Discards the event being logged.
+        DropNewest,
+
+        /// @brief Discards the oldest queued event to make room.
+        ///
+        /// Flushes and listener changes are never discarded. One found at the front of the
+        /// queue is queued again behind the newer records, so it takes effect after events that
+        /// were logged after it: a flush then also covers those events, and a listener change
+        /// applies from a later event on. Once a whole queue of them was moved, producers wait
+        /// as with `Block`.
+        DropOldest,
+
+        /// @brief Keeps only a sample of the events below the sampling level once the queue is
+        /// three quarters full, and drops them entirely when it is full. Other events block.
+        SampleLowLevels
+    };
+
+    class LogPipeline;
+
+    /// @brief Returned by `LogPipeline::Flush()`. Awaiting it suspends the coroutine until every
+    /// event logged before the call has been handled and the handlers have flushed.
+    ///
+    /// The coroutine is resumed on the logger thread, or on the thread of the last dedicated
+    /// worker to flush, so move back to your own executor before doing anything slow.
+    /// Unlike `FlushAsync()`, it needs no promise of its own; the handlers' flushes still
+    /// allocate their futures.
+    class LogFlushAwaitable {
+    public:
+        explicit LogFlushAwaitable(LogPipeline& pipeline)
+        : _pipeline(&pipeline), _handle(), _completed(false) {}
+        
+        LogFlushAwaitable(const LogFlushAwaitable&) = delete;
+        LogFlushAwaitable& operator=(const LogFlushAwaitable&) = delete;
+        
+        Bool await_ready() const noexcept { return false; }
+        Bool await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const noexcept {}
+        
+    private:
+        void Complete();
+        
+        LogPipeline* _pipeline;
+        std::coroutine_handle<> _handle;
+        std::atomic<Bool> _completed;
+        
+        friend class LogPipeline;
+    };
+
+    /// @brief An independent logging pipeline: its own queue, event loop, handlers and counters.
+    ///
+    /// `Logger` forwards to the default pipeline. Create more of them to keep unrelated logs
+    /// (say, an audit log and a debug log) from sharing a queue and a consumer thread.
+    /// Each pipeline is bootstrapped on its own with `RunThreaded()`, `RunBlocking()` or
+    /// `RunManualPoll()`, and must outlive every `NamedLogger` bound to it.
+    class LogPipeline {
         using Handler = AsyncEventHandler<IAsyncLogEventDelegate>;
         using HandlerRef = std::unique_ptr<Handler>;
-        using RecordCall = std::queue<std::function<void()>>;
+        /// @brief A queued record, which is either an event to dispatch or a hook to run.
+        struct RecordCall {
+            Handle<LoggerEventArgs> event;
+            std::function<void()> action;
+        };
+        
+        using RecordQueue = ConcurrentRingBuffer<RecordCall>;
+
+    public:
+        /// @brief The number of pending records the queue can hold before producers have to wait.
+        static constexpr std::size_t QueueCapacity = 8192;
+        
+        /// @brief The maximum number of records `PollEvents()` detaches from the queue at once.
+        static constexpr std::size_t MaxBatchSize = 256;
+        
+        /// @brief Under `QueueFullPolicy::SampleLowLevels`, one in this many sampled events is kept.
+        static constexpr UInt32 SampleRate = 16;
+        
+        explicit LogPipeline(std::size_t queueCapacity = QueueCapacity);
+        
+        /// @brief Stops the event loop after it dispatched everything queued, then stops the
+        /// dedicated workers. Events queued in manual-poll mode and never polled are discarded.
+        ~LogPipeline();
+        
+        LogPipeline(const LogPipeline&) = delete;
+        LogPipeline& operator=(const LogPipeline&) = delete;
+        
+        /// @brief Gets the pipeline behind `Logger`. It is never destroyed, so its thread can keep
+        /// running while the process exits.
+        static LogPipeline& GetDefault() {
+            static LogPipeline* pipeline = new LogPipeline();
+            return *pipeline;
+        }
+
+    private:
+        HandlerRef _loggedHandler;
+        RecordQueue _recordCall;
+        IdleWaiter _idleWaiter;
+        Bool _bootstrapped;
+        std::atomic<Bool> _isRunning;
+        
+        /// @brief The thread running the event loop. Empty until it has started, so that no other
+        /// thread mistakes itself for the logger thread in the meantime.
+        std::atomic<std::thread::id> _threadId;
+        std::thread _thread;
+        std::vector<RecordCall> _pollBatch;
+        std::vector<Handle<LoggerEventArgs>> _eventBatch;
+        LoggerEventPool _eventPool;
+        std::vector<Handle<LogSinkWorker>> _sinkWorkers;
+        std::vector<Handle<LoggerEventArgs>> _inFlight;
+        std::vector<std::pair<Handle<IAsyncLogEventDelegate>, Handle<LogSinkMetrics>>> _handlerMetrics;
+        
+        /// @brief Guards changes to `_sinkWorkers` and `_handlerMetrics` against `GetMetrics()`.
+        /// The thread applying the changes reads them without it.
+        mutable std::mutex _listenersMutex;
+        Handle<LogCrashRing> _crashRing;
+        std::atomic<UInt64> _dispatched;
+        std::atomic<std::size_t> _queueHighWater;
+        LatencyHistogram _latency;
+        std::atomic<LogLevel> _minimumLevel;
+        std::atomic<QueueFullPolicy> _queueFullPolicy;
+        std::atomic<LogLevel> _sampleLevel;
+        std::atomic<UInt32> _sampleCounter;
+        std::atomic<UInt64> _droppedEvents[(std::size_t) LogLevel::Fatal + 1];
+        std::atomic<UInt64> _droppedTotal;
+        UInt64 _reportedDrops[(std::size_t) LogLevel::Fatal + 1];
+        UInt64 _reportedTotal;
+        
+        void RunEventLoop();
+        void CallOrQueue(RecordCall record);
+        void Enqueue(RecordCall record);
+        Bool TryMakeRoom(RecordCall& record);
+        void DropEvent(Handle<LoggerEventArgs>& event);
+        void ReportDroppedEvents();
+        void InternalOnLogged(Handle<LoggerEventArgs> data);
+        void InternalOnLoggedBatch(LoggerEventBatch events);
+        void FlushHandlers(std::function<void()> done);
+        void FlushThen(LogFlushAwaitable* awaitable);
+        void DispatchBatch();
+        void ReleaseEventBatch();
+        void ReleaseEvent(Handle<LoggerEventArgs>& event);
+        void RecycleInFlight();
+        void RecordDispatch(LoggerEventBatch events);
+        LogSinkMetrics* FindHandlerMetrics(const Handle<IAsyncLogEventDelegate>& handler);
+        void UpdateListeners(std::function<void()> update);
+        void LogText(LogLevel level,
+                     std::string_view text,
+                     Handle<TextColor> color,
+                     std::string_view name);
+        
+        template <typename... TArgs>
+        void LogFormatted(LogLevel level,
+                          std::string_view name,
+                          std::string_view format,
+                          const TArgs&... args) {
+            CallOrQueue({ _eventPool.AcquireFormatted(level, GetLogLevelColor(level), name, format, args...), nullptr });
+        }
+        
+        template <typename... TArgs>
+        void LogTaggedOrFormatted(LogLevel level,
+                                  std::string_view format,
+                                  Bool isTagged,
+                                  const TArgs&... args) {
+            if constexpr (sizeof...(TArgs) == 1 && (std::is_convertible_v<const TArgs&, std::string_view> && ...)) {
+                if (isTagged) {
+                    LogText(level, format, GetLogLevelColor(level), std::string_view(args...));
+                    return;
+                }
+            }
+            
+            LogFormatted(level, "Logger", format, args...);
+        }
+        
+        friend class NamedLogger;
+        friend class LogFlushAwaitable;
+
+    public:
+        /// @brief Registers a handler. Once the pipeline runs, the change is handed to the logger
+        /// thread like a flush, so that it never races with dispatching: with `RunThreaded()` or
+        /// `RunBlocking()` the call returns once it is applied, with `RunManualPoll()` it is
+        /// applied by the next `PollEvents()`.
+        void AddLoggedListener(Handle<IAsyncLogEventDelegate> delegate,
+                               LogSinkDispatch dispatch = LogSinkDispatch::LoggerThread);
+        
+        /// @brief Unregisters a handler, on the logger thread like `AddLoggedListener()`.
+        void RemoveLoggedListener(Handle<IAsyncLogEventDelegate> delegate);
+        /// @brief Sets how the event loop waits while the queue is empty.
+        /// Call this before `RunThreaded()` or `RunBlocking()`.
+        void SetWaitStrategy(WaitStrategy strategy,
+                             UInt32 spinCount = IdleWaiter::DefaultSpinCount);
+        void RunThreaded();
+        void RunManualPoll();
+        void RunBlocking();
+        void Join();
+        void PollEvents();
+        std::future<void> FlushAsync();
+        
+        /// @brief Like `FlushAsync()`, for coroutines: `co_await pipeline.Flush();`
+        LogFlushAwaitable Flush() { return LogFlushAwaitable(*this); }
+        
+        /// @brief Copies every event into `ring` on the thread logging it, before it is queued,
+        /// so that the events a crash catches in the queue can still be recovered.
+        /// Pass `nullptr` to turn it off. Call this before anything is logged.
+        void SetCrashRing(Handle<LogCrashRing> ring);
+        
+        /// @brief Sets the threshold of this pipeline. Events below it are discarded before
+        /// anything is built. `NamedLogger`s bound to it without a threshold of their own follow this value.
+        void SetMinimumLevel(LogLevel level);
+        LogLevel GetMinimumLevel() const;
+        
+        /// @brief Sets what producers do when the queue is full. The default is `Block`.
+        /// @param sampleLevel Events below this level are sampled by `SampleLowLevels`.
+        void SetQueueFullPolicy(QueueFullPolicy policy, LogLevel sampleLevel = LogLevel::Warn);
+        QueueFullPolicy GetQueueFullPolicy() const;
+        
+        /// @brief Gets the number of events dropped so far because the queue was full.
+        /// Once the queue has drained, the pipeline reports new drops with a warning of its own.
+        UInt64 GetDroppedCount() const;
+        UInt64 GetDroppedCount(LogLevel level) const;
+        
+        /// @brief Reads the pipeline's own counters. Safe to call from any thread; only the list
+        /// of sinks is read under a lock, which listener changes hold briefly.
+        LoggerMetrics GetMetrics() const;
+        
+        /// @brief Gets the enqueue-to-dispatch latency histogram, in nanoseconds.
+        const LatencyHistogram& GetLatencyHistogram() const;
+        
+        Bool IsEnabled(LogLevel level) const {
+            return level >= _minimumLevel.load(std::memory_order_relaxed);
+        }
+        
+        /// @brief Logs a component message. Both components are cloned, so the caller may keep
+        /// mutating them afterwards.
+        void Log(LogLevel level,
+                 Handle<IComponent> text,
+                 Handle<TextColor> color,
+                 Handle<IComponent> name);
+        void Verbose(std::string_view str, std::string_view name = "Logger");
+        void Log(std::string_view str, std::string_view name = "Logger");
+        void Info(std::string_view str, std::string_view name = "Logger");
+        void Warn(std::string_view str, std::string_view name = "Logger");
+        void Error(std::string_view str, std::string_view name = "Logger");
+        void Fatal(std::string_view str, std::string_view name = "Logger");
+        
+        /// @brief Logs a message with typed key/value fields. The fields are copied into the
+        /// event as they are, so sinks can write them out without parsing the message.
+        ///
+        ///     pipeline.LogStructured(LogLevel::Info, "Request served", { { "status", 200 }, { "path", path } });
+        void LogStructured(LogLevel level,
+                           std::string_view text,
+                           std::initializer_list<LogField> fields,
+                           std::string_view name = "Logger");
+        
+        /// @brief Logs through a call site. Used by the `MOCHI_LOG_*` macros.
+        template <typename... TArgs> requires (sizeof...(TArgs) > 0)
+        void LogSite(LogCallSite& site, LogFormatString<std::type_identity_t<TArgs>...> format, TArgs&&... args) {
+            site.Bind(format.Get());
+            CallOrQueue({ _eventPool.AcquireSite(site, nullptr, args...), nullptr });
+        }
+        
+        /// @brief Logs a plain message through a call site.
+        void LogSite(LogCallSite& site, std::string_view text);
+        
+        /// @brief Logs through a call site unless the same message was logged there within the
+        /// window of `dedup`. Used by the `MOCHI_LOG_DEDUP` macros.
+        template <typename... TArgs>
+        void LogDeduplicated(LogCallSite& site, LogDeduplicator& dedup,
+                             LogFormatString<std::type_identity_t<TArgs>...> format, TArgs&&... args) {
+            UInt64 suppressed;
+            if (!dedup.TryAcquire(LogArguments::Hash(format.Get(), args...), suppressed)) return;
+            
+            if (suppressed > 0) LogSuppressed(site, suppressed, site.tag);
+            if constexpr (sizeof...(TArgs) > 0) {
+                LogSite(site, format, std::forward<TArgs>(args)...);
+            } else {
+                LogSite(site, format.Get());
+            }
+        }
+        
+        /// @brief Logs a summary of the repeats a rate-limited or deduplicated site dropped.
+        void LogSuppressed(const LogCallSite& site, UInt64 count, std::string_view tag);
+        
+        // Deferred formatting: only the arguments are copied on the calling thread, the
+        // message is formatted on the logger thread. See `LogFormatString` for the syntax.
+        // A literal without placeholders followed by one string still means (text, tag).
+        
+#define __MC_DEFINE_FORMAT_LOG(level) \
+        template <typename... TArgs> requires (sizeof...(TArgs) > 0) \
+        void level(TaggedLogFormatString<std::type_identity_t<TArgs>...> format, TArgs&&... args) { \
+            if (!IsEnabled(LogLevel::level)) return; \
+            LogTaggedOrFormatted(LogLevel::level, format.Get(), format.IsTagged(), args...); \
+        }
+        
+        __MC_DEFINE_FORMAT_LOG(Verbose)
+        __MC_DEFINE_FORMAT_LOG(Log)
+        __MC_DEFINE_FORMAT_LOG(Info)
+        __MC_DEFINE_FORMAT_LOG(Warn)
+        __MC_DEFINE_FORMAT_LOG(Error)
+        __MC_DEFINE_FORMAT_LOG(Fatal)
+#undef __MC_DEFINE_FORMAT_LOG
+    };
 
+    /// @brief The process-wide logger. Every member forwards to `LogPipeline::GetDefault()`.
+    class Logger {
+    public:
+        static constexpr std::size_t QueueCapacity = LogPipeline::QueueCapacity;
+        static constexpr std::size_t MaxBatchSize = LogPipeline::MaxBatchSize;
+        static constexpr UInt32 SampleRate = LogPipeline::SampleRate;
+        
     private:
-        static HandlerRef _loggedHandler;
-        static RecordCall _recordCall;
-        static std::mutex _recordCallMutex;
         static Bool _isInitialized;
-        static Bool _bootstrapped;
-        static Bool _isRunning;
-        static std::thread::id _threadId;
-        static Handle<std::thread> _thread;
-        
-        static void RunEventLoop();
-        static void CallOrQueue(std::function<void()> action);
-        static void InternalOnLogged(Handle<LoggerEventArgs> data);
-        static void Log(LogLevel level,
-                        Handle<IComponent> text,
-                        Handle<TextColor> color,
-                        Handle<IComponent> name);
+        
+        static LogPipeline& Default() {
+            return LogPipeline::GetDefault();
+        }
 
     public:
         static void Init();
-        static void AddLoggedListener(Handle<IAsyncLogEventDelegate> delegate);
-        static void RemoveLoggedListener(Handle<IAsyncLogEventDelegate> delegate);
-        static void RunThreaded();
-        static void RunManualPoll();
-        static void RunBlocking();
-        static void Join();
-        static void PollEvents();
-        static std::future<void> FlushAsync();
-        static void Info(std::string str, std::string name = "Logger");
-        static void Warn(std::string str, std::string name = "Logger");
-        static void Error(std::string str, std::string name = "Logger");
+        static void AddLoggedListener(Handle<IAsyncLogEventDelegate> delegate,
+                                      LogSinkDispatch dispatch = LogSinkDispatch::LoggerThread) {
+            Default().AddLoggedListener(std::move(delegate), dispatch);
+        }
+        
+        static void RemoveLoggedListener(Handle<IAsyncLogEventDelegate> delegate) {
+            Default().RemoveLoggedListener(std::move(delegate));
+        }
+        
+        /// @brief Sets how the event loop waits while the queue is empty.
+        /// Call this before `RunThreaded()` or `RunBlocking()`.
+        static void SetWaitStrategy(WaitStrategy strategy,
+                                    UInt32 spinCount = IdleWaiter::DefaultSpinCount) {
+            Default().SetWaitStrategy(strategy, spinCount);
+        }
+        
+        static void RunThreaded() { Default().RunThreaded(); }
+        static void RunManualPoll() { Default().RunManualPoll(); }
+        static void RunBlocking() { Default().RunBlocking(); }
+        static void Join() { Default().Join(); }
+        static void PollEvents() { Default().PollEvents(); }
+        static std::future<void> FlushAsync() { return Default().FlushAsync(); }
+        static LogFlushAwaitable Flush() { return Default().Flush(); }
+        
+        /// @brief Copies every event into `ring` before it is queued. See `LogPipeline::SetCrashRing()`.
+        static void SetCrashRing(Handle<LogCrashRing> ring) { Default().SetCrashRing(std::move(ring)); }
+        
+        /// @brief Sets the global threshold. Events below it are discarded before anything is built.
+        /// `NamedLogger`s without a threshold of their own follow this value.
+        static void SetMinimumLevel(LogLevel level) { Default().SetMinimumLevel(level); }
+        static LogLevel GetMinimumLevel() { return Default().GetMinimumLevel(); }
+        
+        /// @brief Sets what producers do when the queue is full. The default is `Block`.
+        /// @param sampleLevel Events below this level are sampled by `SampleLowLevels`.
+        static void SetQueueFullPolicy(QueueFullPolicy policy, LogLevel sampleLevel = LogLevel::Warn) {
+            Default().SetQueueFullPolicy(policy, sampleLevel);
+        }
+        
+        static QueueFullPolicy GetQueueFullPolicy() { return Default().GetQueueFullPolicy(); }
+        
+        /// @brief Gets the number of events dropped so far because the queue was full.
+        /// Once the queue has drained, the logger reports new drops with a warning of its own.
+        static UInt64 GetDroppedCount() { return Default().GetDroppedCount(); }
+        static UInt64 GetDroppedCount(LogLevel level) { return Default().GetDroppedCount(level); }
+        
+        /// @brief Reads the logger's own counters. Lock-free; safe to call from any thread,
+        /// as long as no listener is being added or removed at the same time.
+        static LoggerMetrics GetMetrics() { return Default().GetMetrics(); }
+        
+        /// @brief Gets the enqueue-to-dispatch latency histogram, in nanoseconds.
+        static const LatencyHistogram& GetLatencyHistogram() { return Default().GetLatencyHistogram(); }
+        
+        static Bool IsEnabled(LogLevel level) {
+            return Default().IsEnabled(level);
+        }
+        
+        /// @brief Logs a component message. Both components are cloned, so the caller may keep
+        /// mutating them afterwards.
+        static void Log(LogLevel level,
+                        Handle<IComponent> text,
+                        Handle<TextColor> color,
+                        Handle<IComponent> name) {
+            Default().Log(level, std::move(text), std::move(color), std::move(name));
+        }
+        
+        static void Verbose(std::string_view str, std::string_view name = "Logger") { Default().Verbose(str, name); }
+        static void Log(std::string_view str, std::string_view name = "Logger") { Default().Log(str, name); }
+        static void Info(std::string_view str, std::string_view name = "Logger") { Default().Info(str, name); }
+        static void Warn(std::string_view str, std::string_view name = "Logger") { Default().Warn(str, name); }
+        static void Error(std::string_view str, std::string_view name = "Logger") { Default().Error(str, name); }
+        static void Fatal(std::string_view str, std::string_view name = "Logger") { Default().Fatal(str, name); }
+        
+        /// @brief Logs a message with typed key/value fields. The fields are copied into the
+        /// event as they are, so sinks can write them out without parsing the message.
+        static void LogStructured(LogLevel level,
+                                  std::string_view text,
+                                  std::initializer_list<LogField> fields,
+                                  std::string_view name = "Logger") {
+            Default().LogStructured(level, text, fields, name);
+        }
+        
+        /// @brief Logs through a call site. Used by the `MOCHI_LOG_*` macros.
+        template <typename... TArgs> requires (sizeof...(TArgs) > 0)
+        static void LogSite(LogCallSite& site, LogFormatString<std::type_identity_t<TArgs>...> format, TArgs&&... args) {
+            Default().LogSite(site, format, std::forward<TArgs>(args)...);
+        }
+        
+        /// @brief Logs a plain message through a call site.
+        static void LogSite(LogCallSite& site, std::string_view text) {
+            Default().LogSite(site, text);
+        }
+        
+        /// @brief Logs through a call site unless the same message was logged there within the
+        /// window of `dedup`. Used by the `MOCHI_LOG_DEDUP` macros.
+        template <typename... TArgs>
+        static void LogDeduplicated(LogCallSite& site, LogDeduplicator& dedup,
+                                    LogFormatString<std::type_identity_t<TArgs>...> format, TArgs&&... args) {
+            Default().LogDeduplicated(site, dedup, format, std::forward<TArgs>(args)...);
+        }
+        
+        /// @brief Logs a summary of the repeats a rate-limited or deduplicated site dropped.
+        static void LogSuppressed(const LogCallSite& site, UInt64 count, std::string_view tag) {
+            Default().LogSuppressed(site, count, tag);
+        }
+        
+#define __MC_DEFINE_FORMAT_LOG(level) \
+        template <typename... TArgs> requires (sizeof...(TArgs) > 0) \
+        static void level(TaggedLogFormatString<std::type_identity_t<TArgs>...> format, TArgs&&... args) { \
+            Default().level(format, std::forward<TArgs>(args)...); \
+        }
+        
+        __MC_DEFINE_FORMAT_LOG(Verbose)
+        __MC_DEFINE_FORMAT_LOG(Log)
+        __MC_DEFINE_FORMAT_LOG(Info)
+        __MC_DEFINE_FORMAT_LOG(Warn)
+        __MC_DEFINE_FORMAT_LOG(Error)
+        __MC_DEFINE_FORMAT_LOG(Fatal)
+#undef __MC_DEFINE_FORMAT_LOG
     };
 
     class NamedLogger {
     private:
         std::string _name;
+        LogTag _tag;
+        LogPipeline* _pipeline;
+        std::atomic<LogLevel> _minimumLevel;
+        Bool _hasOwnLevel;
+        
+        void Register();
+        void Unregister();
+        void LogText(LogLevel level, std::string_view str);
+        
+        friend class LogPipeline;
+        
     public:
         NamedLogger(std::string name);
         
-        void Info(std::string str);
-        void Warn(std::string str);
-        void Error(std::string str);
+        /// @brief Creates a logger that sends its events to `pipeline` instead of the default one.
+        NamedLogger(std::string name, LogPipeline& pipeline);
+        NamedLogger(const NamedLogger& other);
+        NamedLogger& operator=(const NamedLogger& other);
+        ~NamedLogger();
+        
+        /// @brief Overrides the global threshold for this logger only.
+        void SetMinimumLevel(LogLevel level);
+        
+        /// @brief Makes this logger follow the threshold of its pipeline again.
+        void ResetMinimumLevel();
+        
+        LogPipeline& GetPipeline() const {
+            return *_pipeline;
+        }
+        
+        /// @brief Gets the interned tag every event of this logger shares.
+        const LogTag& GetTag() const {
+            return _tag;
+        }
+        
+        /// @brief Awaits a flush of the pipeline this logger writes to.
+        LogFlushAwaitable Flush() const {
+            return _pipeline->Flush();
+        }
+        
+        Bool IsEnabled(LogLevel level) const {
+            return level >= _minimumLevel.load(std::memory_order_relaxed);
+        }
+        
+        void Verbose(std::string_view str);
+        void Log(std::string_view str);
+        void Info(std::string_view str);
+        void Warn(std::string_view str);
+        void Error(std::string_view str);
+        void Fatal(std::string_view str);
+        
+        /// @brief Logs a message with typed key/value fields under this logger's name.
+        void LogStructured(LogLevel level, std::string_view text, std::initializer_list<LogField> fields);
+        
+        template <typename... TArgs> requires (sizeof...(TArgs) > 0)
+        void LogSite(LogCallSite& site, LogFormatString<std::type_identity_t<TArgs>...> format, TArgs&&... args) {
+            site.Bind(format.Get());
+            _pipeline->CallOrQueue({ _pipeline->_eventPool.AcquireSite(site, &_tag, args...), nullptr });
+        }
+        
+        void LogSite(LogCallSite& site, std::string_view text);
+        
+        template <typename... TArgs>
+        void LogDeduplicated(LogCallSite& site, LogDeduplicator& dedup,
+                             LogFormatString<std::type_identity_t<TArgs>...> format, TArgs&&... args) {
+            UInt64 suppressed;
+            if (!dedup.TryAcquire(LogArguments::Hash(format.Get(), args...), suppressed)) return;
+            
+            if (suppressed > 0) _pipeline->LogSuppressed(site, suppressed, _name);
+            if constexpr (sizeof...(TArgs) > 0) {
+                LogSite(site, format, std::forward<TArgs>(args)...);
+            } else {
+                LogSite(site, format.Get());
+            }
+        }
+        
+        /// @brief Logs a summary of the repeats a rate-limited or deduplicated site dropped.
+        void LogSuppressed(const LogCallSite& site, UInt64 count) {
+            _pipeline->LogSuppressed(site, count, _name);
+        }
+        
+#define __MC_DEFINE_FORMAT_LOG(level) \
+        template <typename... TArgs> requires (sizeof...(TArgs) > 0) \
+        void level(LogFormatString<std::type_identity_t<TArgs>...> format, TArgs&&... args) { \
+            if (!IsEnabled(LogLevel::level)) return; \
+            _pipeline->CallOrQueue({ _pipeline->_eventPool.AcquireFormatted( \
+                LogLevel::level, GetLogLevelColor(LogLevel::level), _tag, format.Get(), args...), nullptr }); \
+        }
+        
+        __MC_DEFINE_FORMAT_LOG(Verbose)
+        __MC_DEFINE_FORMAT_LOG(Log)
+        __MC_DEFINE_FORMAT_LOG(Info)
+        __MC_DEFINE_FORMAT_LOG(Warn)
+        __MC_DEFINE_FORMAT_LOG(Error)
+        __MC_DEFINE_FORMAT_LOG(Fatal)
+#undef __MC_DEFINE_FORMAT_LOG
     };
 
 }
 
+// MARK: - Compile-time log elision
+//
+// The MOCHI_LOG_* macros check the threshold before evaluating their arguments, and expand to
+// nothing at all when their level is below MOCHI_LOG_MIN_LEVEL. Each statement registers a
+// LogCallSite, so its events only carry a site pointer and the packed arguments. Release builds (NDEBUG) strip
+// Verbose and Log statements unless MOCHI_LOG_MIN_LEVEL is defined explicitly.
+
+#define MOCHI_LOG_LEVEL_VERBOSE 0
+#define MOCHI_LOG_LEVEL_LOG     1
+#define MOCHI_LOG_LEVEL_INFO    2
+#define MOCHI_LOG_LEVEL_WARN    3
+#define MOCHI_LOG_LEVEL_ERROR   4
+#define MOCHI_LOG_LEVEL_FATAL   5
+
+#if !defined(MOCHI_LOG_MIN_LEVEL)
+#   if defined(NDEBUG)
+#       define MOCHI_LOG_MIN_LEVEL MOCHI_LOG_LEVEL_INFO
+#   else
+#       define MOCHI_LOG_MIN_LEVEL MOCHI_LOG_LEVEL_VERBOSE
+#   endif
+#endif // !defined(MOCHI_LOG_MIN_LEVEL)
+
+static_assert(MOCHI_LOG_LEVEL_VERBOSE == (int) ::MOCHI_NAMESPACE::LogLevel::Verbose &&
+              MOCHI_LOG_LEVEL_FATAL   == (int) ::MOCHI_NAMESPACE::LogLevel::Fatal,
+              "MOCHI_LOG_LEVEL_* must match LogLevel");
+
+#define __MOCHI_LOG_IF_ENABLED(level, ...) \
+    do { \
+        if (::MOCHI_NAMESPACE::Logger::IsEnabled(::MOCHI_NAMESPACE::LogLevel::level)) { \
+            static constinit ::MOCHI_NAMESPACE::LogCallSite __mochiSite(::MOCHI_NAMESPACE::LogLevel::level, "Logger"); \
+            ::MOCHI_NAMESPACE::Logger::LogSite(__mochiSite, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define __MOCHI_NAMED_LOG_IF_ENABLED(logger, level, ...) \
+    do { \
+        auto& __mochiLogger = (logger); \
+        if (__mochiLogger.IsEnabled(::MOCHI_NAMESPACE::LogLevel::level)) { \
+            static constinit ::MOCHI_NAMESPACE::LogCallSite __mochiSite(::MOCHI_NAMESPACE::LogLevel::level, ""); \
+            __mochiLogger.LogSite(__mochiSite, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#if MOCHI_LOG_MIN_LEVEL <= MOCHI_LOG_LEVEL_VERBOSE
+#   define MOCHI_LOG_VERBOSE(...)               __MOCHI_LOG_IF_ENABLED(Verbose, __VA_ARGS__)
+#   define MOCHI_NAMED_LOG_VERBOSE(logger, ...) __MOCHI_NAMED_LOG_IF_ENABLED(logger, Verbose, __VA_ARGS__)
+#else
+#   define MOCHI_LOG_VERBOSE(...)               ((void) 0)
+#   define MOCHI_NAMED_LOG_VERBOSE(logger, ...) ((void) 0)
+#endif
+
+#if MOCHI_LOG_MIN_LEVEL <= MOCHI_LOG_LEVEL_LOG
+#   define MOCHI_LOG_LOG(...)                   __MOCHI_LOG_IF_ENABLED(Log, __VA_ARGS__)
+#   define MOCHI_NAMED_LOG_LOG(logger, ...)     __MOCHI_NAMED_LOG_IF_ENABLED(logger, Log, __VA_ARGS__)
+#else
+#   define MOCHI_LOG_LOG(...)                   ((void) 0)
+#   define MOCHI_NAMED_LOG_LOG(logger, ...)     ((void) 0)
+#endif
+
+#if MOCHI_LOG_MIN_LEVEL <= MOCHI_LOG_LEVEL_INFO
+#   define MOCHI_LOG_INFO(...)                  __MOCHI_LOG_IF_ENABLED(Info, __VA_ARGS__)
+#   define MOCHI_NAMED_LOG_INFO(logger, ...)    __MOCHI_NAMED_LOG_IF_ENABLED(logger, Info, __VA_ARGS__)
+#else
+#   define MOCHI_LOG_INFO(...)                  ((void) 0)
+#   define MOCHI_NAMED_LOG_INFO(logger, ...)    ((void) 0)
+#endif
+
+#if MOCHI_LOG_MIN_LEVEL <= MOCHI_LOG_LEVEL_WARN
+#   define MOCHI_LOG_WARN(...)                  __MOCHI_LOG_IF_ENABLED(Warn, __VA_ARGS__)
+#   define MOCHI_NAMED_LOG_WARN(logger, ...)    __MOCHI_NAMED_LOG_IF_ENABLED(logger, Warn, __VA_ARGS__)
+#else
+#   define MOCHI_LOG_WARN(...)                  ((void) 0)
+#   define MOCHI_NAMED_LOG_WARN(logger, ...)    ((void) 0)
+#endif
+
+#if MOCHI_LOG_MIN_LEVEL <= MOCHI_LOG_LEVEL_ERROR
+#   define MOCHI_LOG_ERROR(...)                 __MOCHI_LOG_IF_ENABLED(Error, __VA_ARGS__)
+#   define MOCHI_NAMED_LOG_ERROR(logger, ...)   __MOCHI_NAMED_LOG_IF_ENABLED(logger, Error, __VA_ARGS__)
+#else
+#   define MOCHI_LOG_ERROR(...)                 ((void) 0)
+#   define MOCHI_NAMED_LOG_ERROR(logger, ...)   ((void) 0)
+#endif
+
+// Fatal statements are never stripped.
+#define MOCHI_LOG_FATAL(...)                    __MOCHI_LOG_IF_ENABLED(Fatal, __VA_ARGS__)
+#define MOCHI_NAMED_LOG_FATAL(logger, ...)      __MOCHI_NAMED_LOG_IF_ENABLED(logger, Fatal, __VA_ARGS__)
+
+// MARK: - Rate limiting and deduplication
+//
+// LEVEL is one of VERBOSE, LOG, INFO, WARN, ERROR or FATAL. Dropped calls never reach the
+// queue; the next call that gets through logs a "suppressed N repeats" summary first.
+//
+//     MOCHI_LOG_LIMITED(WARN, 1, 5, "Retrying {}", host);       // 1 per second, bursts of 5
+//     MOCHI_LOG_DEDUP(WARN, 1000, "Retrying {}", host);         // once per host per second
+//
+// Rate-limited statements only evaluate their arguments when they get through. Deduplicated
+// statements have to evaluate them to tell messages apart.
+
+#define __MOCHI_LOG_KEEPS(LEVEL) \
+    (MOCHI_LOG_LEVEL_##LEVEL >= MOCHI_LOG_MIN_LEVEL || MOCHI_LOG_LEVEL_##LEVEL == MOCHI_LOG_LEVEL_FATAL)
+
+#define MOCHI_LOG_LIMITED(LEVEL, perSecond, burst, ...) \
+    do { \
+        if constexpr (__MOCHI_LOG_KEEPS(LEVEL)) { \
+            constexpr auto __mochiLevel = (::MOCHI_NAMESPACE::LogLevel) MOCHI_LOG_LEVEL_##LEVEL; \
+            if (::MOCHI_NAMESPACE::Logger::IsEnabled(__mochiLevel)) { \
+                static constinit ::MOCHI_NAMESPACE::LogCallSite __mochiSite(__mochiLevel, "Logger"); \
+                static constinit ::MOCHI_NAMESPACE::LogRateLimiter __mochiLimiter(perSecond, burst); \
+                ::MOCHI_NAMESPACE::UInt64 __mochiSuppressed; \
+                if (__mochiLimiter.TryAcquire(__mochiSuppressed)) { \
+                    if (__mochiSuppressed > 0) { \
+                        ::MOCHI_NAMESPACE::Logger::LogSuppressed(__mochiSite, __mochiSuppressed, __mochiSite.tag); \
+                    } \
+                    ::MOCHI_NAMESPACE::Logger::LogSite(__mochiSite, __VA_ARGS__); \
+                } \
+            } \
+        } \
+    } while (0)
+
+#define MOCHI_NAMED_LOG_LIMITED(logger, LEVEL, perSecond, burst, ...) \
+    do { \
+        if constexpr (__MOCHI_LOG_KEEPS(LEVEL)) { \
+            constexpr auto __mochiLevel = (::MOCHI_NAMESPACE::LogLevel) MOCHI_LOG_LEVEL_##LEVEL; \
+            auto& __mochiLogger = (logger); \
+            if (__mochiLogger.IsEnabled(__mochiLevel)) { \
+                static constinit ::MOCHI_NAMESPACE::LogCallSite __mochiSite(__mochiLevel, ""); \
+                static constinit ::MOCHI_NAMESPACE::LogRateLimiter __mochiLimiter(perSecond, burst); \
+                ::MOCHI_NAMESPACE::UInt64 __mochiSuppressed; \
+                if (__mochiLimiter.TryAcquire(__mochiSuppressed)) { \
+                    if (__mochiSuppressed > 0) __mochiLogger.LogSuppressed(__mochiSite, __mochiSuppressed); \
+                    __mochiLogger.LogSite(__mochiSite, __VA_ARGS__); \
+                } \
+            } \
+        } \
+    } while (0)
+
+#define MOCHI_LOG_DEDUP(LEVEL, windowMs, ...) \
+    do { \
+        if constexpr (__MOCHI_LOG_KEEPS(LEVEL)) { \
+            constexpr auto __mochiLevel = (::MOCHI_NAMESPACE::LogLevel) MOCHI_LOG_LEVEL_##LEVEL; \
+            if (::MOCHI_NAMESPACE::Logger::IsEnabled(__mochiLevel)) { \
+                static constinit ::MOCHI_NAMESPACE::LogCallSite __mochiSite(__mochiLevel, "Logger"); \
+                static constinit ::MOCHI_NAMESPACE::LogDeduplicator __mochiDedup(std::chrono::milliseconds(windowMs)); \
+                ::MOCHI_NAMESPACE::Logger::LogDeduplicated(__mochiSite, __mochiDedup, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define MOCHI_NAMED_LOG_DEDUP(logger, LEVEL, windowMs, ...) \
+    do { \
+        if constexpr (__MOCHI_LOG_KEEPS(LEVEL)) { \
+            constexpr auto __mochiLevel = (::MOCHI_NAMESPACE::LogLevel) MOCHI_LOG_LEVEL_##LEVEL; \
+            auto& __mochiLogger = (logger); \
+            if (__mochiLogger.IsEnabled(__mochiLevel)) { \
+                static constinit ::MOCHI_NAMESPACE::LogCallSite __mochiSite(__mochiLevel, ""); \
+                static constinit ::MOCHI_NAMESPACE::LogDeduplicator __mochiDedup(std::chrono::milliseconds(windowMs)); \
+                __mochiLogger.LogDeduplicated(__mochiSite, __mochiDedup, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
 #endif /* logging_h */
 #endif
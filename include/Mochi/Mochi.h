@@ -9,8 +9,17 @@
 #include <Mochi/Core.h>
 #include <Mochi/Meta.h>
 #include <Mochi/Foundation.h>
+#include <Mochi/Concurrent.h>
+#include <Mochi/LogFormat.h>
+#include <Mochi/LogFields.h>
+#include <Mochi/LogClock.h>
+#include <Mochi/LogMetrics.h>
+#include <Mochi/JsonReader.h>
 #include <Mochi/Components.h>
 #include <Mochi/Logging.h>
+#include <Mochi/LogSinks.h>
+#include <Mochi/LogCrashRing.h>
+#include <Mochi/LogTask.h>
 #include <Mochi/Data.h>
 
 #endif //MOCHI_MOCHI_H
@@ -6,6 +6,12 @@
 //
 
 #include <Mochi/Components.h>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
 
 namespace MOCHI_NAMESPACE {
 
@@ -55,30 +61,32 @@ namespace MOCHI_NAMESPACE {
     __MC_DEFINE_COLORS
     #undef __MC_DEFINE_COLOR
 
+    TextColor::Ref TextColor::FromName(std::string_view name) {
+        auto it = _byName.find(name);
+        return it == _byName.end() ? nullptr : it->second;
+    }
+
     // MARK: -
 
     TextColor::Ref BasicColoredStyle::GetColor() {
         return _color;
     }
 
-    IColoredStyle::Ref BasicColoredStyle::WithColor(TextColor::Ref color) {
-        _color = color;
-        return GetRef<IStyle>(this);
+    IColoredStyle::Ref BasicColoredStyle::Recolored(TextColor::Ref color) {
+        return Of(std::move(color));
     }
 
     IStyle::Ref BasicColoredStyle::ApplyTo(IStyle::Ref other) {
-        auto o = ::MOCHI_NAMESPACE::AssertSubType<IColoredStyle>(other);
-        
-        auto self = GetRef<IStyle>(this);
-        if (self == _empty) return o;
-        if (other == _empty) return self;
+        // Styles are immutable, so the result is always one of the two: ours if we have a
+        // color, otherwise the one we inherit from
+        if (_color) return shared_from_this();
+        if (this == _empty.get()) return other;
         
-        auto color = _color;
-        if (color == nullptr) {
-            color = o->GetColor();
+        if (!dynamic_cast<IColoredStyle*>(other.get())) {
+            return ::MOCHI_NAMESPACE::AssertSubType<IColoredStyle>(other);
         }
         
-        return CreateRef<BasicColoredStyle>()->WithColor(color);
+        return other;
     }
 
     void BasicColoredStyle::SerializeInto(Json::Value obj) {
@@ -92,10 +100,79 @@ namespace MOCHI_NAMESPACE {
     BasicColoredStyle::Ref BasicColoredStyle::_empty = CreateRef<BasicColoredStyle>();
     BasicColoredStyle::Ref BasicColoredStyle::Empty() { return _empty; }
 
+    static BasicColoredStyle::Ref ColoredStyleFromJson(const Json::Value& obj) {
+        if (!obj.isObject()) return BasicColoredStyle::Empty();
+        
+        auto &color = obj["color"];
+        if (!color.isString()) return BasicColoredStyle::Empty();
+        return BasicColoredStyle::Of(TextColor::FromName(color.asString()));
+    }
+
+    BasicColoredStyle::Ref BasicColoredStyle::FromJson(Json::Value obj) {
+        return ColoredStyleFromJson(obj);
+    }
+
+    // The interned styles, one per color. Colors are few and live for the whole program, so
+    // the styles are never removed. Styles for the first colors are published in a fixed table
+    // indexed by ordinal and found without taking the lock.
+    struct BasicColoredStyleTable {
+        static constexpr int FastCount = 64;
+        
+        std::atomic<const BasicColoredStyle::Ref*> fast[FastCount] {};
+        std::mutex mutex;
+        std::map<TextColor*, BasicColoredStyle::Ref> styles;
+    };
+
+    static BasicColoredStyleTable& GetStyleTable() {
+        static BasicColoredStyleTable table;
+        return table;
+    }
+
+    BasicColoredStyle::Ref BasicColoredStyle::Of(TextColor::Ref color) {
+        if (!color) return _empty;
+        
+        auto &table = GetStyleTable();
+        auto ordinal = color->GetOrdinal();
+        auto isFast = ordinal >= 0 && ordinal < BasicColoredStyleTable::FastCount;
+        if (isFast) {
+            if (auto style = table.fast[ordinal].load(std::memory_order_acquire)) return *style;
+        }
+        
+        std::lock_guard lock(table.mutex);
+        auto [it, inserted] = table.styles.try_emplace(color.get());
+        if (inserted) {
+            auto style = CreateRef<BasicColoredStyle>();
+            style->_color = std::move(color);
+            it->second = std::move(style);
+        }
+        
+        // Map nodes never move, so the table can point right at the handle
+        if (isFast) table.fast[ordinal].store(&it->second, std::memory_order_release);
+        return it->second;
+    }
+
     // MARK: -
 
-    // MARK: TextContentTypes::_types
-    TextContentTypes::Registry TextContentTypes::_types = TextContentTypes::Registry();
+    IContent::Ref IContentType::ReadContent(std::string_view key, JsonReader& reader) {
+        // Copy the key first: reading the value may overwrite it
+        std::string name(key);
+        
+        Json::Value payload(Json::objectValue);
+        payload[name] = reader.ReadValue();
+        return CreateContent(std::move(payload));
+    }
+
+    // MARK: TextContentTypes::GetTypes()
+    TextContentTypes::Registry& TextContentTypes::GetTypes() {
+        static Registry types;
+        return types;
+    }
+
+    IContentType::Ref TextContentTypes::Find(std::string_view key) {
+        auto &types = GetTypes();
+        auto it = types.find(key);
+        return it == types.end() ? nullptr : it->second;
+    }
 
     // MARK: -
 
@@ -131,10 +208,14 @@ namespace MOCHI_NAMESPACE {
         return CreateRef<LiteralContent>(text);
     }
 
-    void LiteralContentType::InsertPayload(Json::Value target, IContent::Ref content) {
+    void LiteralContentType::InsertPayload(Json::Value, IContent::Ref) {
         ::MOCHI_NAMESPACE::ThrowNotImplemented();
     }
 
+    IContent::Ref LiteralContentType::ReadContent(std::string_view, JsonReader& reader) {
+        return CreateRef<LiteralContent>(reader.ReadString());
+    }
+
     std::shared_ptr<LiteralContentType> TextContentTypes::e_Literal = TextContentTypes::Register("text", std::make_shared<LiteralContentType>());
     std::shared_ptr<LiteralContentType> TextContentTypes::Literal() {
         return e_Literal;
@@ -144,19 +225,64 @@ namespace MOCHI_NAMESPACE {
 
     class GenericMutableComponent : public IMutableComponent {
     private:
+        using SiblingList = std::pmr::list<IComponent::Ref>;
+        
         IContent::Ref _content;
         IStyle::Ref _style;
-        std::list<IComponent::Ref> _siblings;
+        
+        // Shared with clones until one of them appends. Null until the first sibling.
+        Handle<SiblingList> _siblings;
+        std::pmr::memory_resource* _resource;
+        
+        // Set once a clone shares this node, which is never changed again. Only nodes nobody
+        // else holds are frozen, and they are only handed out as copies, so this is written
+        // before any other thread can see the node.
+        Bool _isFrozen = false;
+        
+        /// @brief Freezes `node` and everything below it if no handle outside of the tree can
+        /// reach it, so that clones can share it.
+        /// @return false if some of it is held elsewhere, and has to be copied instead.
+        static Bool Freeze(const IComponent::Ref& node) {
+            auto component = dynamic_cast<GenericMutableComponent*>(node.get());
+            if (!component) return false;
+            if (component->_isFrozen) return true;
+            if (node.use_count() > 1 || !component->FreezeSiblings()) return false;
+            
+            component->_isFrozen = true;
+            return true;
+        }
+        
+        Bool FreezeSiblings() {
+            if (!_siblings) return true;
+            
+            // Freeze what can be even if some sibling cannot, so that copying shares the rest
+            Bool result = true;
+            for (auto &sibling : *_siblings) {
+                result = Freeze(sibling) && result;
+            }
+            
+            return result;
+        }
+        
+        static IComponent::Ref Unfreeze(const IComponent::Ref& node) {
+            auto component = dynamic_cast<GenericMutableComponent*>(node.get());
+            return component && component->_isFrozen ? IComponent::Ref(node->Clone()) : node;
+        }
         
     public:
         GenericMutableComponent(IContent::Ref content,
-                                IStyle::Ref style):
-        _content(content), _style(style), _siblings() {}
+                                IStyle::Ref style,
+                                std::pmr::memory_resource* resource = std::pmr::get_default_resource()):
+        _content(content), _style(style), _resource(resource) {}
         
         IContent::Ref GetContent() override {
             return _content;
         }
         
+        void SetContent(IContent::Ref content) {
+            _content = std::move(content);
+        }
+        
         IStyle::Ref GetStyle() override {
             return _style;
         }
@@ -166,14 +292,52 @@ namespace MOCHI_NAMESPACE {
         }
         
         std::list<IComponent::Ref> GetSiblings() override {
-            return _siblings;
+            if (!_siblings) return {};
+            
+            auto isShared = std::any_of(_siblings->begin(), _siblings->end(), [](auto& sibling) {
+                auto component = dynamic_cast<GenericMutableComponent*>(sibling.get());
+                return component && component->_isFrozen;
+            });
+            
+            if (!isShared) return std::list<IComponent::Ref>(_siblings->begin(), _siblings->end());
+            
+            // The caller may change what it gets, so shared siblings are swapped for copies first.
+            // Copies go to the heap.
+            auto siblings = CreateRef<SiblingList>();
+            for (auto &sibling : *_siblings) {
+                siblings->push_back(Unfreeze(sibling));
+            }
+            
+            if (!_isFrozen) _siblings = siblings;
+            return std::list<IComponent::Ref>(siblings->begin(), siblings->end());
+        }
+        
+        void Append(IComponent::Ref sibling) override {
+            if (!_siblings) {
+                _siblings = std::allocate_shared<SiblingList>(std::pmr::polymorphic_allocator<SiblingList>(_resource));
+            } else if (_siblings.use_count() > 1) {
+                // Copy on write: clones keep the list as it was. Copies go to the heap.
+                _siblings = CreateRef<SiblingList>(*_siblings);
+            }
+            
+            _siblings->push_back(std::move(sibling));
         }
         
         IMutableComponent::Ref Clone() override {
+            // Clones always go to the heap, even when cloning a tree built in an arena. The parts
+            // of the tree that only this node can reach are frozen and shared; siblings somebody
+            // else holds, and whatever leads to them, are copied.
             auto result = CreateRef<GenericMutableComponent>(_content, _style);
-            for (auto sibling : _siblings) {
-                auto clone = sibling->Clone();
-                result->GetSiblings().push_back(clone);
+            if (!_siblings) return result;
+            
+            if (FreezeSiblings()) {
+                result->_siblings = _siblings;
+                return result;
+            }
+            
+            result->_siblings = CreateRef<SiblingList>();
+            for (auto &sibling : *_siblings) {
+                result->_siblings->push_back(Freeze(sibling) ? sibling : IComponent::Ref(sibling->Clone()));
             }
             
             return result;
@@ -182,8 +346,9 @@ namespace MOCHI_NAMESPACE {
         void Visit(IContentVisitor::Ref visitor, IStyle::Ref style) override {
             style = _style->ApplyTo(style);
             _content->Visit(visitor, style);
+            if (!_siblings) return;
             
-            for (auto sibling : _siblings) {
+            for (auto &sibling : *_siblings) {
                 sibling->Visit(visitor, style);
             }
         }
@@ -191,8 +356,9 @@ namespace MOCHI_NAMESPACE {
         void VisitLiteral(IContentVisitor::Ref visitor, IStyle::Ref style) override {
             style = _style->ApplyTo(style);
             _content->VisitLiteral(visitor, style);
+            if (!_siblings) return;
             
-            for (auto sibling : _siblings) {
+            for (auto &sibling : *_siblings) {
                 sibling->VisitLiteral(visitor, style);
             }
         }
@@ -200,19 +366,347 @@ namespace MOCHI_NAMESPACE {
 
     // MARK: -
 
+    static Handle<GenericMutableComponent> ComponentFromJson(const Json::Value& obj,
+                                                             const Component::JsonStyleParseFn& parseStyle) {
+        if (obj.isArray()) {
+            if (obj.empty()) throw std::runtime_error("A component array cannot be empty.");
+            
+            auto root = ComponentFromJson(obj[0], parseStyle);
+            for (Json::ArrayIndex i = 1; i < obj.size(); i++) {
+                root->Append(ComponentFromJson(obj[i], parseStyle));
+            }
+            
+            return root;
+        }
+        
+        if (!obj.isObject()) {
+            if (obj.isNull()) throw std::runtime_error("A component cannot be null.");
+            return CreateRef<GenericMutableComponent>(CreateRef<LiteralContent>(obj.asString()),
+                                                      BasicColoredStyle::Empty());
+        }
+        
+        // Members are sorted by key, so the first content key found is the one that sorts first
+        IContent::Ref content;
+        for (auto it = obj.begin(); it != obj.end() && !content; ++it) {
+            if (auto type = TextContentTypes::Find(it.name())) {
+                content = type->CreateContent(obj);
+            }
+        }
+        
+        if (!content) throw std::runtime_error("Component has no known content: " + obj.toStyledString());
+        
+        // Without a parser there is no need to copy the object for it
+        IStyle::Ref style = parseStyle ? parseStyle(obj) : ColoredStyleFromJson(obj);
+        auto result = CreateRef<GenericMutableComponent>(std::move(content), style ? style : BasicColoredStyle::Empty());
+        
+        auto &extra = obj["extra"];
+        if (extra.isNull()) return result;
+        if (!extra.isArray()) throw std::runtime_error("The extra of a component must be an array.");
+        
+        for (auto &sibling : extra) {
+            result->Append(ComponentFromJson(sibling, parseStyle));
+        }
+        
+        return result;
+    }
+
     IComponent::Ref Component::FromJson(Json::Value obj,
                                         Component::JsonStyleParseFn parseStyle) {
-        ::MOCHI_NAMESPACE::ThrowNotImplemented();
+        return ComponentFromJson(obj, parseStyle);
     }
 
     IComponent::Ref Component::FromJson(Json::Value obj) {
-        ::MOCHI_NAMESPACE::ThrowNotImplemented();
-        // return FromJson(obj, );
+        return ComponentFromJson(obj, nullptr);
+    }
+
+    // Builds the components as the reader goes, without a document in between
+    class JsonComponentReader {
+    public:
+        JsonComponentReader(JsonReader& reader, const Component::JsonStyleParseFn& parseStyle)
+        : _reader(reader), _parseStyle(parseStyle) {}
+        
+        Handle<GenericMutableComponent> Read() {
+            switch (_reader.Peek()) {
+                case Json::objectValue:
+                    return ReadObject();
+                case Json::arrayValue:
+                    return ReadArray();
+                case Json::stringValue:
+                    return CreateLiteral(_reader.ReadString());
+                case Json::booleanValue:
+                    return CreateLiteral(_reader.ReadBool() ? "true" : "false");
+                case Json::nullValue:
+                    _reader.Fail("a component cannot be null");
+                default:
+                    // Through a document, so numbers read as the text FromJson() makes of them
+                    return CreateLiteral(_reader.ReadValue().asString());
+            }
+        }
+        
+    private:
+        static Handle<GenericMutableComponent> CreateLiteral(std::string text) {
+            return CreateRef<GenericMutableComponent>(CreateRef<LiteralContent>(std::move(text)),
+                                                      BasicColoredStyle::Empty());
+        }
+        
+        Handle<GenericMutableComponent> ReadArray() {
+            _reader.BeginArray();
+            if (!_reader.NextElement()) _reader.Fail("a component array cannot be empty");
+            
+            auto root = Read();
+            while (_reader.NextElement()) {
+                root->Append(Read());
+            }
+            
+            return root;
+        }
+        
+        Handle<GenericMutableComponent> ReadObject() {
+            // Members come in any order, so the content is filled in once it shows up
+            auto result = CreateRef<GenericMutableComponent>(nullptr, BasicColoredStyle::Empty());
+            Bool hasContent = false;
+            std::string contentKey;
+            Json::Value styleMembers;
+            
+            _reader.BeginObject();
+            
+            std::string_view key;
+            while (_reader.NextKey(key)) {
+                if (auto type = TextContentTypes::Find(key)) {
+                    // Of several content members, the one whose key sorts first wins, as in
+                    // FromJson(). The others are skipped.
+                    if (hasContent && key >= contentKey) {
+                        _reader.Skip();
+                        continue;
+                    }
+                    
+                    contentKey = key;
+                    result->SetContent(type->ReadContent(contentKey, _reader));
+                    hasContent = true;
+                    continue;
+                }
+                
+                if (key == "extra") {
+                    _reader.BeginArray();
+                    while (_reader.NextElement()) {
+                        result->Append(Read());
+                    }
+                } else if (_parseStyle) {
+                    std::string name(key);
+                    styleMembers[name] = _reader.ReadValue();
+                } else if (key == "color" && _reader.Peek() == Json::stringValue) {
+                    // Anything but a name leaves the style empty, as in FromJson()
+                    result->SetStyle(BasicColoredStyle::Of(TextColor::FromName(_reader.ReadStringView())));
+                } else {
+                    _reader.Skip();
+                }
+            }
+            
+            if (!hasContent) _reader.Fail("component has no known content");
+            
+            if (_parseStyle) {
+                if (styleMembers.isNull()) styleMembers = Json::Value(Json::objectValue);
+                if (auto style = _parseStyle(std::move(styleMembers))) result->SetStyle(std::move(style));
+            }
+            
+            return result;
+        }
+        
+        JsonReader& _reader;
+        const Component::JsonStyleParseFn& _parseStyle;
+    };
+
+    IComponent::Ref Component::ParseJson(std::string_view json,
+                                         Component::JsonStyleParseFn parseStyle) {
+        JsonReader reader(json);
+        auto result = ReadJson(reader, std::move(parseStyle));
+        reader.ExpectEnd();
+        return result;
+    }
+
+    IComponent::Ref Component::ParseJson(std::string_view json) {
+        return ParseJson(json, nullptr);
+    }
+
+    IComponent::Ref Component::ReadJson(JsonReader& reader,
+                                        Component::JsonStyleParseFn parseStyle) {
+        return JsonComponentReader(reader, parseStyle).Read();
+    }
+
+    IComponent::Ref Component::ReadJson(JsonReader& reader) {
+        return ReadJson(reader, nullptr);
     }
 
     IComponent::Ref Component::Literal(std::string text) {
         return std::make_shared<GenericMutableComponent>(std::make_shared<LiteralContent>(text),
-                                                        std::make_shared<BasicColoredStyle>());
+                                                        BasicColoredStyle::Empty());
+    }
+
+    // MARK: -
+
+    ComponentRuns ComponentRuns::Compile(const IComponent::Ref& component, IStyle::Ref style) {
+        ComponentRuns runs;
+        
+        component->VisitLiteral(IContentVisitor::Create([&runs](IContent::Ref content, IStyle::Ref style) {
+            auto literal = dynamic_cast<LiteralContent*>(content.get());
+            if (!literal || literal->text.empty()) return;
+            
+            auto &entries = runs._entries;
+            if (!entries.empty() && entries.back().style == style) {
+                entries.back().length += literal->text.size();
+            } else {
+                entries.push_back(Entry { runs._text.size(), literal->text.size(), std::move(style) });
+            }
+            
+            runs._text += literal->text;
+        }), std::move(style));
+        
+        return runs;
+    }
+
+    // MARK: -
+
+    ComponentArena::ComponentArena(std::size_t blockSize)
+    : _blockSize(std::max<std::size_t>(blockSize, 256)), _blocks(nullptr), _cursor(nullptr), _end(nullptr),
+      _owner(std::this_thread::get_id()), _isOwned(true), _ownerBalance(0), _sharedBalance(OwnerHold) {}
+
+    ComponentArena::~ComponentArena() {
+        auto block = _blocks.load(std::memory_order_relaxed);
+        while (block) {
+            ::operator delete(std::exchange(block, block->next));
+        }
+    }
+
+    ComponentArena* ComponentArena::Create(std::size_t blockSize) {
+        return new ComponentArena(blockSize);
+    }
+
+    void ComponentArena::Release() {
+        _isOwned.store(false, std::memory_order_relaxed);
+        Settle(_ownerBalance - OwnerHold);
+    }
+
+    void ComponentArena::Settle(std::ptrdiff_t count) {
+        // Allocations and deallocations on other threads move the shared balance either way, but
+        // it stays far from zero until Release() takes back the hold and hands over the owner's share
+        if (_sharedBalance.fetch_add(count, std::memory_order_acq_rel) + count == 0) {
+            delete this;
+        }
+    }
+
+    Bool ComponentArena::Contains(const void* p) const {
+        // Blocks are only ever pushed in front, each one complete before it is published
+        for (auto block = _blocks.load(std::memory_order_acquire); block; block = block->next) {
+            auto address = (std::uintptr_t) p;
+            if (address >= (std::uintptr_t) (block + 1) && address < (std::uintptr_t) block->end) return true;
+        }
+        
+        return false;
+    }
+
+    void* ComponentArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+        // The cursor is the owner's alone: everyone else, and everything after Release(), gets
+        // the default resource, e.g. a sibling list appended to an arena node on another thread.
+        // They are still counted, since they are given back through the arena.
+        if (!_isOwned.load(std::memory_order_relaxed) || std::this_thread::get_id() != _owner) {
+            auto result = std::pmr::get_default_resource()->allocate(bytes, alignment);
+            _sharedBalance.fetch_add(1, std::memory_order_relaxed);
+            return result;
+        }
+        
+        _ownerBalance++;
+        auto cursor = (UInt8*) (((std::uintptr_t) _cursor + alignment - 1) & ~(std::uintptr_t) (alignment - 1));
+        if (!_cursor || cursor + bytes > _end) return AllocateFromNewBlock(bytes, alignment);
+        
+        _cursor = cursor + bytes;
+        return cursor;
+    }
+
+    void* ComponentArena::AllocateFromNewBlock(std::size_t bytes, std::size_t alignment) {
+        // Each block is twice the size of the previous one, so a big tree only takes a few
+        if (_blocks) _blockSize = std::min<std::size_t>(_blockSize * 2, 1 << 20);
+        auto size = std::max(_blockSize, sizeof(Block) + alignment + bytes);
+        
+        auto block = (Block*) ::operator new(size);
+        block->next = _blocks.load(std::memory_order_relaxed);
+        block->end = (UInt8*) block + size;
+        _blocks.store(block, std::memory_order_release);
+        
+        auto result = (UInt8*) (((std::uintptr_t) (block + 1) + alignment - 1) & ~(std::uintptr_t) (alignment - 1));
+        _cursor = result + bytes;
+        _end = block->end;
+        return result;
+    }
+
+    void ComponentArena::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+        if (!Contains(p)) {
+            std::pmr::get_default_resource()->deallocate(p, bytes, alignment);
+            Settle(-1);
+            return;
+        }
+        
+        // Nothing is reused; the blocks go back together with the last allocation
+        if (_isOwned.load(std::memory_order_relaxed) && std::this_thread::get_id() == _owner) {
+            _ownerBalance--;
+        } else {
+            Settle(-1);
+        }
+    }
+
+    bool ComponentArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+    // MARK: -
+
+    ComponentBuilder::ComponentBuilder(std::size_t blockSize)
+    : _blockSize(blockSize), _arena(ComponentArena::Create(blockSize)) {}
+
+    ComponentBuilder::~ComponentBuilder() {
+        _arena->Release();
+    }
+
+    void ComponentBuilder::Reset() {
+        _arena->Release();
+        _arena = ComponentArena::Create(_blockSize);
+    }
+
+    IMutableComponent::Ref ComponentBuilder::Create(IContent::Ref content, IStyle::Ref style) {
+        return Allocate<GenericMutableComponent>(std::move(content), std::move(style), _arena);
+    }
+
+    IMutableComponent::Ref ComponentBuilder::Literal(std::string_view text) {
+        return Create(Allocate<LiteralContent>(std::string(text)), BasicColoredStyle::Empty());
+    }
+
+    IMutableComponent::Ref ComponentBuilder::Literal(std::string_view text, TextColor::Ref color) {
+        return Create(Allocate<LiteralContent>(std::string(text)), Style(std::move(color)));
+    }
+
+    IColoredStyle::Ref ComponentBuilder::Style(TextColor::Ref color) {
+        return BasicColoredStyle::Of(std::move(color));
+    }
+
+    // MARK: -
+
+    void Component::AppendPlainText(const IComponent::Ref& component, std::string& out) {
+        // Most components are a single literal, which needs no visitor
+        auto content = component->GetContent();
+        if (auto literal = dynamic_cast<LiteralContent*>(content.get())) {
+            out += literal->text;
+            
+            for (auto &sibling : component->GetSiblings()) {
+                AppendPlainText(sibling, out);
+            }
+            
+            return;
+        }
+        
+        component->VisitLiteral(IContentVisitor::Create([&out](IContent::Ref content, IStyle::Ref) {
+            if (auto literal = dynamic_cast<LiteralContent*>(content.get())) {
+                out += literal->text;
+            }
+        }), BasicColoredStyle::Empty());
     }
 
 }
@@ -0,0 +1,358 @@
+//
+//  JsonReader.cpp
+//  Mochi
+//
+
+#include <Mochi/JsonReader.h>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace MOCHI_NAMESPACE {
+
+    static Bool IsDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static void AppendUtf8(std::string& out, UInt32 codePoint) {
+        if (codePoint < 0x80) {
+            out += (char) codePoint;
+        } else if (codePoint < 0x800) {
+            out += (char) (0xc0 | (codePoint >> 6));
+            out += (char) (0x80 | (codePoint & 0x3f));
+        } else if (codePoint < 0x10000) {
+            out += (char) (0xe0 | (codePoint >> 12));
+            out += (char) (0x80 | ((codePoint >> 6) & 0x3f));
+            out += (char) (0x80 | (codePoint & 0x3f));
+        } else {
+            out += (char) (0xf0 | (codePoint >> 18));
+            out += (char) (0x80 | ((codePoint >> 12) & 0x3f));
+            out += (char) (0x80 | ((codePoint >> 6) & 0x3f));
+            out += (char) (0x80 | (codePoint & 0x3f));
+        }
+    }
+
+    JsonReader::JsonReader(std::string_view json)
+    : _json(json), _cursor(0), _depth(0), _isFirst(true) {}
+
+    void JsonReader::Fail(std::string_view reason) const {
+        throw std::runtime_error("Invalid JSON at offset " + std::to_string(_cursor) + ": " + std::string(reason));
+    }
+
+    void JsonReader::SkipWhitespace() {
+        while (_cursor < _json.size()) {
+            auto c = _json[_cursor];
+            if (c != ' ' && c != '\n' && c != '\r' && c != '\t') return;
+            _cursor++;
+        }
+    }
+
+    void JsonReader::Expect(char c) {
+        if (_cursor >= _json.size() || _json[_cursor] != c) {
+            Fail(std::string("expected '") + c + "'");
+        }
+
+        _cursor++;
+    }
+
+    void JsonReader::Enter() {
+        if (++_depth > MaxDepth) Fail("nested too deeply");
+    }
+
+    Json::ValueType JsonReader::Peek() {
+        SkipWhitespace();
+        if (_cursor >= _json.size()) Fail("unexpected end of input");
+
+        auto c = _json[_cursor];
+        switch (c) {
+            case '{': return Json::objectValue;
+            case '[': return Json::arrayValue;
+            case '"': return Json::stringValue;
+            case 't':
+            case 'f': return Json::booleanValue;
+            case 'n': return Json::nullValue;
+            default:
+                if (c == '-' || IsDigit(c)) return Json::realValue;
+                Fail("unexpected character");
+        }
+    }
+
+    std::string_view JsonReader::ReadStringView() {
+        SkipWhitespace();
+        Expect('"');
+
+        // Most strings have no escapes and can be handed out as they are
+        auto begin = _cursor;
+        while (_cursor < _json.size()) {
+            auto c = _json[_cursor];
+            if (c == '"') {
+                return _json.substr(begin, _cursor++ - begin);
+            }
+
+            if (c == '\\') break;
+            if ((unsigned char) c < 0x20) Fail("control character in string");
+            _cursor++;
+        }
+
+        _scratch.assign(_json.data() + begin, _cursor - begin);
+        while (_cursor < _json.size()) {
+            auto c = _json[_cursor];
+            if (c == '"') {
+                _cursor++;
+                return _scratch;
+            }
+
+            if (c == '\\') {
+                AppendEscape();
+                continue;
+            }
+
+            if ((unsigned char) c < 0x20) Fail("control character in string");
+            _scratch += c;
+            _cursor++;
+        }
+
+        Fail("unterminated string");
+    }
+
+    void JsonReader::AppendEscape() {
+        // Past the backslash
+        if (++_cursor >= _json.size()) Fail("unterminated string");
+
+        auto c = _json[_cursor++];
+        switch (c) {
+            case '"':  _scratch += '"';  return;
+            case '\\': _scratch += '\\'; return;
+            case '/':  _scratch += '/';  return;
+            case 'b':  _scratch += '\b'; return;
+            case 'f':  _scratch += '\f'; return;
+            case 'n':  _scratch += '\n'; return;
+            case 'r':  _scratch += '\r'; return;
+            case 't':  _scratch += '\t'; return;
+            case 'u':  break;
+            default:   Fail("invalid escape");
+        }
+
+        auto readUnit = [this]() -> UInt32 {
+            if (_cursor + 4 > _json.size()) Fail("truncated \\u escape");
+
+            UInt32 unit = 0;
+            auto result = std::from_chars(_json.data() + _cursor, _json.data() + _cursor + 4, unit, 16);
+            if (result.ptr != _json.data() + _cursor + 4) Fail("invalid \\u escape");
+
+            _cursor += 4;
+            return unit;
+        };
+
+        auto unit = readUnit();
+        if (unit >= 0xd800 && unit < 0xdc00 && _json.substr(_cursor, 2) == "\\u") {
+            _cursor += 2;
+            auto low = readUnit();
+            if (low >= 0xdc00 && low < 0xe000) {
+                AppendUtf8(_scratch, 0x10000 + ((unit - 0xd800) << 10) + (low - 0xdc00));
+                return;
+            }
+
+            // Not a pair after all: both halves stand alone
+            AppendUtf8(_scratch, 0xfffd);
+            unit = low;
+        }
+
+        // Unpaired surrogates cannot be encoded
+        AppendUtf8(_scratch, unit >= 0xd800 && unit < 0xe000 ? 0xfffd : unit);
+    }
+
+    std::string_view JsonReader::ReadNumberText() {
+        SkipWhitespace();
+
+        auto begin = _cursor;
+        auto digits = [this]() {
+            auto start = _cursor;
+            while (_cursor < _json.size() && IsDigit(_json[_cursor])) _cursor++;
+            if (_cursor == start) Fail("expected a digit");
+        };
+
+        if (_cursor < _json.size() && _json[_cursor] == '-') _cursor++;
+        if (_cursor < _json.size() && _json[_cursor] == '0') {
+            _cursor++;
+        } else {
+            digits();
+        }
+
+        if (_cursor < _json.size() && _json[_cursor] == '.') {
+            _cursor++;
+            digits();
+        }
+
+        if (_cursor < _json.size() && (_json[_cursor] == 'e' || _json[_cursor] == 'E')) {
+            _cursor++;
+            if (_cursor < _json.size() && (_json[_cursor] == '+' || _json[_cursor] == '-')) _cursor++;
+            digits();
+        }
+
+        return _json.substr(begin, _cursor - begin);
+    }
+
+    double JsonReader::ReadNumber() {
+        auto text = ReadNumberText();
+
+        double result = 0;
+        std::from_chars(text.data(), text.data() + text.size(), result);
+        return result;
+    }
+
+    std::string_view JsonReader::ReadLiteral(std::string_view word) {
+        SkipWhitespace();
+        if (_json.substr(_cursor, word.size()) != word) {
+            Fail("expected " + std::string(word));
+        }
+
+        _cursor += word.size();
+        return word;
+    }
+
+    Bool JsonReader::ReadBool() {
+        SkipWhitespace();
+        if (_cursor < _json.size() && _json[_cursor] == 't') {
+            ReadLiteral("true");
+            return true;
+        }
+
+        ReadLiteral("false");
+        return false;
+    }
+
+    void JsonReader::ReadNull() {
+        ReadLiteral("null");
+    }
+
+    void JsonReader::BeginObject() {
+        SkipWhitespace();
+        Expect('{');
+        Enter();
+        _isFirst = true;
+    }
+
+    Bool JsonReader::NextKey(std::string_view& key) {
+        SkipWhitespace();
+        if (_cursor < _json.size() && _json[_cursor] == '}') {
+            _cursor++;
+            _depth--;
+            _isFirst = false;
+            return false;
+        }
+
+        if (!_isFirst) Expect(',');
+        _isFirst = false;
+
+        key = ReadStringView();
+        SkipWhitespace();
+        Expect(':');
+        return true;
+    }
+
+    void JsonReader::BeginArray() {
+        SkipWhitespace();
+        Expect('[');
+        Enter();
+        _isFirst = true;
+    }
+
+    Bool JsonReader::NextElement() {
+        SkipWhitespace();
+        if (_cursor < _json.size() && _json[_cursor] == ']') {
+            _cursor++;
+            _depth--;
+            _isFirst = false;
+            return false;
+        }
+
+        if (!_isFirst) Expect(',');
+        _isFirst = false;
+        return true;
+    }
+
+    void JsonReader::Skip() {
+        switch (Peek()) {
+            case Json::objectValue: {
+                BeginObject();
+                std::string_view key;
+                while (NextKey(key)) Skip();
+                return;
+            }
+            case Json::arrayValue:
+                BeginArray();
+                while (NextElement()) Skip();
+                return;
+            case Json::stringValue:
+                ReadStringView();
+                return;
+            case Json::booleanValue:
+                ReadBool();
+                return;
+            case Json::nullValue:
+                ReadNull();
+                return;
+            default:
+                ReadNumberText();
+                return;
+        }
+    }
+
+    Json::Value JsonReader::ReadValue() {
+        switch (Peek()) {
+            case Json::objectValue: {
+                Json::Value result(Json::objectValue);
+                BeginObject();
+
+                std::string_view key;
+                while (NextKey(key)) {
+                    // The key may live in the scratch buffer, which reading the value reuses
+                    std::string name(key);
+                    result[name] = ReadValue();
+                }
+
+                return result;
+            }
+            case Json::arrayValue: {
+                Json::Value result(Json::arrayValue);
+                BeginArray();
+                while (NextElement()) result.append(ReadValue());
+                return result;
+            }
+            case Json::stringValue:
+                return Json::Value(std::string(ReadStringView()));
+            case Json::booleanValue:
+                return Json::Value(ReadBool());
+            case Json::nullValue:
+                ReadNull();
+                return Json::Value();
+            default: {
+                // Keep integers exact, the way jsoncpp reads them
+                auto text = ReadNumberText();
+                if (text.find_first_of(".eE") == std::string_view::npos) {
+                    // Out of range, from_chars still consumes every digit, so the error has to be checked
+                    Json::Int64 value = 0;
+                    auto end = text.data() + text.size();
+                    auto result = std::from_chars(text.data(), end, value);
+                    if (result.ec == std::errc() && result.ptr == end) return Json::Value(value);
+
+                    Json::UInt64 unsignedValue = 0;
+                    result = std::from_chars(text.data(), end, unsignedValue);
+                    if (result.ec == std::errc() && result.ptr == end) return Json::Value(unsignedValue);
+                }
+
+                double value = 0;
+                std::from_chars(text.data(), text.data() + text.size(), value);
+                return Json::Value(value);
+            }
+        }
+    }
+
+    void JsonReader::ExpectEnd() {
+        SkipWhitespace();
+        if (_cursor != _json.size()) Fail("unexpected trailing characters");
+    }
+
+}
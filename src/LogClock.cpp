@@ -0,0 +1,232 @@
+//
+//  LogClock.cpp
+//  Mochi
+//
+
+#include <Mochi/LogClock.h>
+#include <ctime>
+#include <limits>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#   include <intrin.h>
+#   define MOCHI_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#   include <cpuid.h>
+#   include <x86intrin.h>
+#   define MOCHI_HAS_TSC 1
+#else
+#   define MOCHI_HAS_TSC 0
+#endif
+
+namespace MOCHI_NAMESPACE {
+
+    std::atomic<LogClockSource> LogClock::_source = LogClockSource::System;
+    std::atomic<UInt32> LogClock::_anchorSequence = 0;
+    std::atomic<UInt64> LogClock::_anchorTsc = 0;
+    std::atomic<Int64>  LogClock::_anchorNanos = 0;
+    std::atomic<UInt64> LogClock::_nanosPerTick = 0;
+    std::atomic<UInt64> LogClock::_resyncTicks = 0;
+
+    static UInt64 ReadTsc() {
+#if MOCHI_HAS_TSC
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    static Int64 SystemNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    static LogClock::TimePoint FromNanos(Int64 nanos) {
+        return LogClock::TimePoint(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(nanos)));
+    }
+
+    static Bool HasInvariantTsc() {
+#if MOCHI_HAS_TSC && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0x80000000);
+        if ((unsigned) info[0] < 0x80000007) return false;
+        __cpuid(info, 0x80000007);
+        return (info[3] & (1 << 8)) != 0;
+#elif MOCHI_HAS_TSC
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+        return (edx & (1 << 8)) != 0;
+#else
+        return false;
+#endif
+    }
+
+    Bool LogClock::IsSupported(LogClockSource source) {
+        switch (source) {
+            case LogClockSource::System:
+                return true;
+            case LogClockSource::Coarse:
+#if defined(CLOCK_REALTIME_COARSE)
+                return true;
+#else
+                return false;
+#endif
+            case LogClockSource::Tsc: {
+                static Bool supported = HasInvariantTsc();
+                return supported;
+            }
+            default:
+                return false;
+        }
+    }
+
+    Bool LogClock::SetSource(LogClockSource source) {
+        if (!IsSupported(source)) return false;
+
+        if (source == LogClockSource::Tsc) {
+            // Measure the counter frequency against the wall clock
+            auto startNanos = SystemNanos();
+            auto startTsc = ReadTsc();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            auto endNanos = SystemNanos();
+            auto endTsc = ReadTsc();
+
+            if (endTsc <= startTsc || endNanos <= startNanos) return false;
+
+            auto nanosPerTick = (UInt64) (((double) (endNanos - startNanos) / (double) (endTsc - startTsc)) * 4294967296.0);
+            auto ticksPerSecond = (UInt64) ((double) (endTsc - startTsc) * 1e9 / (double) (endNanos - startNanos));
+
+            auto sequence = _anchorSequence.load(std::memory_order_relaxed);
+            _anchorSequence.store(sequence | 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            _anchorTsc.store(endTsc, std::memory_order_relaxed);
+            _anchorNanos.store(endNanos, std::memory_order_relaxed);
+            _nanosPerTick.store(nanosPerTick, std::memory_order_relaxed);
+            _resyncTicks.store(ticksPerSecond, std::memory_order_relaxed);
+            _anchorSequence.store((sequence | 1) + 1, std::memory_order_release);
+        }
+
+        _source.store(source, std::memory_order_relaxed);
+        return true;
+    }
+
+    LogClockSource LogClock::GetSource() {
+        return _source.load(std::memory_order_relaxed);
+    }
+
+    LogClock::TimePoint LogClock::CoarseNow() {
+#if defined(CLOCK_REALTIME_COARSE)
+        timespec time;
+        clock_gettime(CLOCK_REALTIME_COARSE, &time);
+        return FromNanos((Int64) time.tv_sec * 1000000000 + time.tv_nsec);
+#else
+        return std::chrono::system_clock::now();
+#endif
+    }
+
+    LogClock::TimePoint LogClock::TscNow() {
+        auto tsc = ReadTsc();
+
+        for (;;) {
+            auto sequence = _anchorSequence.load(std::memory_order_acquire);
+            if (sequence & 1) {
+                // Someone is re-anchoring right now
+                return std::chrono::system_clock::now();
+            }
+
+            auto anchorTsc = _anchorTsc.load(std::memory_order_relaxed);
+            auto anchorNanos = _anchorNanos.load(std::memory_order_relaxed);
+            auto nanosPerTick = _nanosPerTick.load(std::memory_order_relaxed);
+            auto resyncTicks = _resyncTicks.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (_anchorSequence.load(std::memory_order_relaxed) != sequence) continue;
+
+            // Counters of other cores may be slightly behind the anchor
+            if (tsc < anchorTsc) tsc = anchorTsc;
+
+            auto elapsed = tsc - anchorTsc;
+            if (elapsed >= resyncTicks) return Resync(tsc);
+
+            return FromNanos(anchorNanos + (Int64) ((elapsed * nanosPerTick) >> 32));
+        }
+    }
+
+    LogClock::TimePoint LogClock::Resync(UInt64 tsc) {
+        auto sequence = _anchorSequence.load(std::memory_order_relaxed);
+        auto nanos = SystemNanos();
+
+        if ((sequence & 1) || !_anchorSequence.compare_exchange_strong(sequence, sequence | 1, std::memory_order_acquire)) {
+            return FromNanos(nanos);
+        }
+
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // Refine the frequency over the whole interval since the last anchor
+        auto anchorTsc = _anchorTsc.load(std::memory_order_relaxed);
+        auto anchorNanos = _anchorNanos.load(std::memory_order_relaxed);
+        if (tsc > anchorTsc && nanos > anchorNanos) {
+            auto ratio = (double) (nanos - anchorNanos) / (double) (tsc - anchorTsc);
+            _nanosPerTick.store((UInt64) (ratio * 4294967296.0), std::memory_order_relaxed);
+            _resyncTicks.store((UInt64) (1e9 / ratio), std::memory_order_relaxed);
+        }
+
+        _anchorTsc.store(tsc, std::memory_order_relaxed);
+        _anchorNanos.store(nanos, std::memory_order_relaxed);
+        _anchorSequence.store(sequence + 2, std::memory_order_release);
+        return FromNanos(nanos);
+    }
+
+    // MARK: -
+
+    TimestampFormatter::TimestampFormatter(TimestampPrecision precision, Bool utc)
+    : _precision(precision), _utc(utc), _cachedSecond(std::numeric_limits<Int64>::min()), _prefixLength(0), _prefix() {}
+
+    void TimestampFormatter::Append(std::string& out, LogClock::TimePoint timestamp) {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count();
+        auto second = micros / 1000000;
+        auto fraction = micros % 1000000;
+        if (fraction < 0) {
+            second--;
+            fraction += 1000000;
+        }
+
+        if (second != _cachedSecond) {
+            auto timeT = (std::time_t) second;
+            std::tm time {};
+
+#if defined(_WIN32)
+            if (_utc) gmtime_s(&time, &timeT); else localtime_s(&time, &timeT);
+#else
+            if (_utc) gmtime_r(&timeT, &time); else localtime_r(&timeT, &time);
+#endif
+
+            _prefixLength = std::strftime(_prefix, sizeof(_prefix), "%Y-%m-%d %H:%M:%S", &time);
+            _cachedSecond = second;
+        }
+
+        out.append(_prefix, _prefixLength);
+        if (_precision == TimestampPrecision::Seconds) return;
+
+        int digits = _precision == TimestampPrecision::Milliseconds ? 3 : 6;
+        if (digits == 3) fraction /= 1000;
+
+        char buffer[7];
+        buffer[0] = '.';
+        for (int i = digits; i >= 1; i--) {
+            buffer[i] = (char) ('0' + fraction % 10);
+            fraction /= 10;
+        }
+
+        out.append(buffer, digits + 1);
+    }
+
+    std::string TimestampFormatter::Format(LogClock::TimePoint timestamp) {
+        std::string result;
+        Append(result, timestamp);
+        return result;
+    }
+
+}
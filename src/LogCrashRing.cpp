@@ -0,0 +1,446 @@
+//
+//  LogCrashRing.cpp
+//  Mochi
+//
+
+#include <Mochi/LogCrashRing.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#if defined(_WIN32)
+#   define WIN32_LEAN_AND_MEAN
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
+
+namespace MOCHI_NAMESPACE {
+
+    // Everything below lives in the mapped file, so the layout is fixed: no pointers, and the
+    // counters are only ever touched through std::atomic_ref.
+
+    struct LogCrashRingHeader {
+        char magic[8];
+        UInt32 version;
+        UInt32 slotSize;
+        UInt64 slotCount;
+        UInt64 nextSequence;
+    };
+
+    struct LogCrashRingSlot {
+        UInt64 sequence;        // 0 while being written
+        UInt32 checksum;
+        UInt16 length;          // of the payload
+        UInt8 level;
+        UInt8 flags;
+        Int64 timestamp;        // microseconds since the epoch
+        UInt64 thread;
+    };
+
+    // The payload is [tag length: 2][tag][text length: 2][text][arguments length: 2][packed
+    // arguments][fields]. Fields run to the end of the payload, each packed the way LogFields
+    // packs it: [type: 1][key length: 2][key][value].
+    // With FormattedFlag set, the text is a format string for the packed arguments.
+    static constexpr UInt8 FormattedFlag = 1;
+    static constexpr UInt8 TruncatedFlag = 2;
+
+    static_assert(sizeof(LogCrashRingHeader) <= LogCrashRing::HeaderSize);
+    static_assert(sizeof(LogCrashRingSlot) == 32);
+
+    static UInt32 ComputeChecksum(const LogCrashRingSlot& slot, UInt64 sequence, const UInt8* payload) {
+        // FNV-1a over the slot header (with its final sequence and no checksum) and the payload
+        UInt32 hash = 0x811c9dc5;
+        auto mix = [&](const UInt8* bytes, std::size_t size) {
+            for (std::size_t i = 0; i < size; i++) {
+                hash ^= bytes[i];
+                hash *= 0x01000193;
+            }
+        };
+
+        auto copy = slot;
+        copy.sequence = sequence;
+        copy.checksum = 0;
+        mix((const UInt8*) &copy, sizeof(copy));
+        mix(payload, slot.length);
+        return hash;
+    }
+
+    // MARK: -
+
+    LogCrashRing::LogCrashRing(const std::string& path, std::size_t slotCount, std::size_t slotSize)
+    : _path(path), _slotCount(std::max<std::size_t>(slotCount, 1)),
+      _slotSize(std::max<std::size_t>((slotSize + 63) / 64 * 64, 128)), _mappedSize(0), _data(nullptr),
+#if defined(_WIN32)
+      _file(INVALID_HANDLE_VALUE), _mapping(nullptr) {
+#else
+      _fd(-1) {
+#endif
+        std::error_code error;
+        if (std::filesystem::exists(path, error)) {
+            std::filesystem::rename(path, path + ".prev", error);
+        }
+
+        Map();
+
+        auto header = (LogCrashRingHeader*) _data;
+        std::memcpy(header->magic, Magic, sizeof(Magic));
+        header->version = Version;
+        header->slotSize = (UInt32) _slotSize;
+        header->slotCount = _slotCount;
+        header->nextSequence = 0;
+    }
+
+    LogCrashRing::~LogCrashRing() {
+        Unmap();
+    }
+
+    void LogCrashRing::Map() {
+        _mappedSize = HeaderSize + _slotCount * _slotSize;
+
+#if defined(_WIN32)
+        _file = CreateFileA(_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (_file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Cannot create crash ring " + _path);
+        }
+
+        _mapping = CreateFileMappingA(_file, nullptr, PAGE_READWRITE,
+                                      (DWORD) ((UInt64) _mappedSize >> 32), (DWORD) _mappedSize, nullptr);
+        _data = _mapping ? (UInt8*) MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, _mappedSize) : nullptr;
+#else
+        _fd = open(_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (_fd < 0) {
+            throw std::runtime_error("Cannot create crash ring " + _path + ": " + std::strerror(errno));
+        }
+
+        if (ftruncate(_fd, (off_t) _mappedSize) == 0) {
+            auto data = mmap(nullptr, _mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+            _data = data == MAP_FAILED ? nullptr : (UInt8*) data;
+        }
+#endif
+
+        if (!_data) {
+            Unmap();
+            throw std::runtime_error("Cannot map crash ring " + _path);
+        }
+    }
+
+    void LogCrashRing::Unmap() {
+#if defined(_WIN32)
+        if (_data) UnmapViewOfFile(_data);
+        if (_mapping) CloseHandle(_mapping);
+        if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+        _mapping = nullptr;
+        _file = INVALID_HANDLE_VALUE;
+#else
+        if (_data) munmap(_data, _mappedSize);
+        if (_fd >= 0) close(_fd);
+        _fd = -1;
+#endif
+
+        _data = nullptr;
+    }
+
+    void LogCrashRing::Sync() {
+#if defined(_WIN32)
+        FlushViewOfFile(_data, _mappedSize);
+#else
+        msync(_data, _mappedSize, MS_ASYNC);
+#endif
+    }
+
+    static std::size_t GetFieldSize(const LogField& field) {
+        auto size = 1 + sizeof(UInt16) + field.GetKey().size();
+        switch (field.GetType()) {
+            case LogFieldType::Bool:
+                return size + 1;
+            case LogFieldType::String:
+                return size + sizeof(UInt32) + field.GetString().size();
+            default:
+                return size + sizeof(UInt64);
+        }
+    }
+
+    static UInt8* PutField(UInt8* cursor, const LogField& field) {
+        auto key = field.GetKey();
+        auto keyLength = (UInt16) key.size();
+        *cursor++ = (UInt8) field.GetType();
+        std::memcpy(cursor, &keyLength, sizeof(keyLength));
+        std::memcpy(cursor + sizeof(keyLength), key.data(), keyLength);
+        cursor += sizeof(keyLength) + keyLength;
+
+        switch (field.GetType()) {
+            case LogFieldType::Int64: {
+                auto value = field.GetInt64();
+                std::memcpy(cursor, &value, sizeof(value));
+                return cursor + sizeof(value);
+            }
+            case LogFieldType::UInt64: {
+                auto value = field.GetUInt64();
+                std::memcpy(cursor, &value, sizeof(value));
+                return cursor + sizeof(value);
+            }
+            case LogFieldType::Double: {
+                auto value = field.GetDouble();
+                std::memcpy(cursor, &value, sizeof(value));
+                return cursor + sizeof(value);
+            }
+            case LogFieldType::Bool:
+                *cursor = field.GetBool() ? 1 : 0;
+                return cursor + 1;
+            case LogFieldType::String: {
+                auto value = field.GetString();
+                auto length = (UInt32) value.size();
+                std::memcpy(cursor, &length, sizeof(length));
+                std::memcpy(cursor + sizeof(length), value.data(), length);
+                return cursor + sizeof(length) + length;
+            }
+        }
+
+        return cursor;
+    }
+
+    // Reads the fields PutField() wrote. Returns false if the payload ends in the middle of one.
+    static Bool TakeFields(std::string_view payload, LogFields& out) {
+        while (!payload.empty()) {
+            auto type = (LogFieldType) (UInt8) payload.front();
+            UInt16 keyLength;
+            if (payload.size() < 1 + sizeof(keyLength)) return false;
+            std::memcpy(&keyLength, payload.data() + 1, sizeof(keyLength));
+            payload.remove_prefix(1 + sizeof(keyLength));
+
+            if (payload.size() < keyLength) return false;
+            auto key = payload.substr(0, keyLength);
+            payload.remove_prefix(keyLength);
+
+            auto takeNumber = [&](auto value) {
+                if (payload.size() < sizeof(value)) return false;
+                std::memcpy(&value, payload.data(), sizeof(value));
+                payload.remove_prefix(sizeof(value));
+                out.Add(key, value);
+                return true;
+            };
+
+            switch (type) {
+                case LogFieldType::Int64:
+                    if (!takeNumber(Int64())) return false;
+                    break;
+                case LogFieldType::UInt64:
+                    if (!takeNumber(UInt64())) return false;
+                    break;
+                case LogFieldType::Double:
+                    if (!takeNumber(double())) return false;
+                    break;
+                case LogFieldType::Bool:
+                    if (payload.empty()) return false;
+                    out.Add(key, payload.front() != 0);
+                    payload.remove_prefix(1);
+                    break;
+                case LogFieldType::String: {
+                    UInt32 length;
+                    if (payload.size() < sizeof(length)) return false;
+                    std::memcpy(&length, payload.data(), sizeof(length));
+                    payload.remove_prefix(sizeof(length));
+                    if (payload.size() < length) return false;
+                    out.Add(key, payload.substr(0, length));
+                    payload.remove_prefix(length);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    // MARK: -
+
+    void LogCrashRing::Write(const LoggerEventPool::Entry& entry) {
+        // Components other than the pooled literals are flattened here, on the producer
+        thread_local std::string tagScratch;
+        thread_local std::string textScratch;
+
+        std::string_view tag;
+        std::string_view text;
+        std::span<const UInt8> arguments;
+        UInt8 flags = 0;
+
+        if (entry.hasPendingFormat && entry.site && !entry.hasTagOverride) {
+            // Not filled in until the logger thread formats the event
+            tag = entry.site->tag;
+        } else if (entry.tag == entry.ownTag) {
+            tag = entry.tagText->text;
+        } else {
+            tagScratch.clear();
+            Component::AppendPlainText(entry.tag, tagScratch);
+            tag = tagScratch;
+        }
+
+        if (entry.hasPendingFormat) {
+            text = entry.site ? entry.site->GetFormat() : entry.format;
+            arguments = entry.arguments;
+            flags |= FormattedFlag;
+        } else if (entry.content == entry.ownContent) {
+            text = entry.contentText->text;
+        } else {
+            textScratch.clear();
+            Component::AppendPlainText(entry.content, textScratch);
+            text = textScratch;
+        }
+
+        auto header = (LogCrashRingHeader*) _data;
+        auto sequence = std::atomic_ref<UInt64>(header->nextSequence).fetch_add(1, std::memory_order_relaxed) + 1;
+        auto slotData = _data + HeaderSize + ((sequence - 1) % _slotCount) * _slotSize;
+        auto& slot = *(LogCrashRingSlot*) slotData;
+        auto payload = slotData + sizeof(LogCrashRingSlot);
+
+        // Invalidate the slot first, so a crash halfway through never leaves the old
+        // sequence number on top of the new contents
+        std::atomic_ref<UInt64>(slot.sequence).store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // Fill the payload, cutting the tag, then the text, then the arguments short, and
+        // leaving out the fields that no longer fit
+        auto capacity = _slotSize - sizeof(LogCrashRingSlot);
+        auto cursor = payload;
+        auto put = [&](std::span<const UInt8> value, std::size_t reserved) {
+            auto room = capacity - (std::size_t) (cursor - payload) - sizeof(UInt16) - reserved;
+            auto length = (UInt16) std::min({ value.size(), room, (std::size_t) std::numeric_limits<UInt16>::max() });
+            if (length < value.size()) flags |= TruncatedFlag;
+
+            // An empty span may have no data to copy from
+            std::memcpy(cursor, &length, sizeof(length));
+            if (length > 0) std::memcpy(cursor + sizeof(length), value.data(), length);
+            cursor += sizeof(length) + length;
+        };
+
+        auto bytes = [](std::string_view value) {
+            return std::span<const UInt8>((const UInt8*) value.data(), value.size());
+        };
+
+        // Leave room for the lengths that follow even if the tag or text is too long
+        put(bytes(tag), 2 * sizeof(UInt16));
+        put(bytes(text), sizeof(UInt16));
+        put(arguments, 0);
+
+        for (auto field : entry.fields) {
+            if (GetFieldSize(field) > capacity - (std::size_t) (cursor - payload)) {
+                flags |= TruncatedFlag;
+                break;
+            }
+
+            cursor = PutField(cursor, field);
+        }
+
+        slot.checksum = 0;
+        slot.length = (UInt16) (cursor - payload);
+        slot.level = (UInt8) entry.level;
+        slot.flags = flags;
+        slot.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(entry.timestamp.time_since_epoch()).count();
+
+        // The raw ID, which is what printing a std::thread::id shows on the usual platforms
+        slot.thread = 0;
+        std::memcpy(&slot.thread, &entry.threadId, std::min(sizeof(slot.thread), sizeof(entry.threadId)));
+
+        // The checksum covers the sequence the slot is about to be published with
+        slot.checksum = ComputeChecksum(slot, sequence, payload);
+
+        std::atomic_ref<UInt64>(slot.sequence).store(sequence, std::memory_order_release);
+    }
+
+    std::vector<DecodedLogRecord> LogCrashRing::Recover(const std::string& path, std::size_t maxRecords) {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream) {
+            throw std::runtime_error("Cannot open crash ring " + path);
+        }
+
+        std::vector<UInt8> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        LogCrashRingHeader header;
+        if (data.size() < HeaderSize) throw std::runtime_error("Not a crash ring file.");
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        if (!std::equal(header.magic, header.magic + sizeof(header.magic), Magic)) {
+            throw std::runtime_error("Not a crash ring file.");
+        }
+
+        if (header.version != Version) {
+            throw std::runtime_error("Unsupported crash ring version: " + std::to_string(header.version));
+        }
+
+        if (header.slotSize < sizeof(LogCrashRingSlot) ||
+            data.size() < HeaderSize + header.slotCount * header.slotSize) {
+            throw std::runtime_error("Truncated crash ring file.");
+        }
+
+        // Collect every intact slot, then put them back in the order they were written
+        std::vector<std::pair<UInt64, std::size_t>> slots;
+        for (UInt64 i = 0; i < header.slotCount; i++) {
+            auto offset = HeaderSize + i * header.slotSize;
+
+            LogCrashRingSlot slot;
+            std::memcpy(&slot, data.data() + offset, sizeof(slot));
+            if (slot.sequence == 0 || slot.length > header.slotSize - sizeof(slot)) continue;
+            if (ComputeChecksum(slot, slot.sequence, data.data() + offset + sizeof(slot)) != slot.checksum) continue;
+
+            slots.emplace_back(slot.sequence, offset);
+        }
+
+        std::sort(slots.begin(), slots.end());
+        if (slots.size() > maxRecords) {
+            slots.erase(slots.begin(), slots.end() - (std::ptrdiff_t) maxRecords);
+        }
+
+        std::vector<DecodedLogRecord> records;
+        records.reserve(slots.size());
+
+        for (auto &[sequence, offset] : slots) {
+            LogCrashRingSlot slot;
+            std::memcpy(&slot, data.data() + offset, sizeof(slot));
+
+            std::string_view payload((const char*) data.data() + offset + sizeof(slot), slot.length);
+            auto take = [&](std::string_view& value) {
+                UInt16 length;
+                if (payload.size() < sizeof(length)) return false;
+                std::memcpy(&length, payload.data(), sizeof(length));
+                payload.remove_prefix(sizeof(length));
+                if (payload.size() < length) return false;
+                value = payload.substr(0, length);
+                payload.remove_prefix(length);
+                return true;
+            };
+
+            std::string_view tag, text, arguments;
+            if (!take(tag) || !take(text)) continue;
+
+            auto truncated = (slot.flags & TruncatedFlag) != 0;
+            if (!take(arguments)) continue;
+
+            auto &record = records.emplace_back();
+            record.level = (LogLevel) slot.level;
+            record.timestamp = std::chrono::time_point<std::chrono::system_clock>(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::microseconds(slot.timestamp)));
+            record.tag = tag;
+            record.thread = std::to_string(slot.thread);
+
+            if (slot.flags & FormattedFlag) {
+                LogArguments::Format(text, std::span<const UInt8>((const UInt8*) arguments.data(), arguments.size()), record.text);
+            } else {
+                record.text = text;
+            }
+
+            if (!TakeFields(payload, record.fields)) truncated = true;
+            if (truncated) record.text += " [truncated]";
+        }
+
+        return records;
+    }
+
+}
@@ -0,0 +1,232 @@
+//
+//  LogFields.cpp
+//  Mochi
+//
+
+#include <Mochi/LogFields.h>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+namespace MOCHI_NAMESPACE {
+
+    // Every field is packed as [type: 1][key length: 2][key][value], where the value is 8 bytes
+    // for numbers, 1 byte for bools and [length: 4][bytes] for strings. Nothing is aligned, so
+    // everything goes through memcpy.
+
+    static std::size_t GetValueSize(LogFieldType type, std::size_t stringLength) {
+        switch (type) {
+            case LogFieldType::Bool:
+                return 1;
+            case LogFieldType::String:
+                return sizeof(UInt32) + stringLength;
+            default:
+                return sizeof(UInt64);
+        }
+    }
+
+    void LogField::AppendValue(std::string& out) const {
+        char buffer[32];
+        std::to_chars_result result {};
+
+        switch (_type) {
+            case LogFieldType::Int64:
+                result = std::to_chars(buffer, buffer + sizeof(buffer), _int);
+                break;
+            case LogFieldType::UInt64:
+                result = std::to_chars(buffer, buffer + sizeof(buffer), _uint);
+                break;
+            case LogFieldType::Double:
+                result = std::to_chars(buffer, buffer + sizeof(buffer), _double);
+                break;
+            case LogFieldType::Bool:
+                out += _bool ? "true" : "false";
+                return;
+            case LogFieldType::String:
+                out.append(_string);
+                return;
+        }
+
+        out.append(buffer, result.ptr);
+    }
+
+    // MARK: -
+
+    LogField LogFields::Iterator::operator*() const {
+        auto cursor = _data + _offset;
+        auto type = (LogFieldType) cursor[0];
+
+        UInt16 keyLength;
+        std::memcpy(&keyLength, cursor + 1, sizeof(keyLength));
+        std::string_view key((const char*) cursor + 1 + sizeof(keyLength), keyLength);
+        cursor += 1 + sizeof(keyLength) + keyLength;
+
+        switch (type) {
+            case LogFieldType::Int64: {
+                Int64 value;
+                std::memcpy(&value, cursor, sizeof(value));
+                return LogField(key, value);
+            }
+            case LogFieldType::UInt64: {
+                UInt64 value;
+                std::memcpy(&value, cursor, sizeof(value));
+                return LogField(key, value);
+            }
+            case LogFieldType::Double: {
+                double value;
+                std::memcpy(&value, cursor, sizeof(value));
+                return LogField(key, value);
+            }
+            case LogFieldType::Bool:
+                return LogField(key, cursor[0] != 0);
+            default: {
+                UInt32 length;
+                std::memcpy(&length, cursor, sizeof(length));
+                return LogField(key, std::string_view((const char*) cursor + sizeof(length), length));
+            }
+        }
+    }
+
+    LogFields::Iterator& LogFields::Iterator::operator++() {
+        auto cursor = _data + _offset;
+        auto type = (LogFieldType) cursor[0];
+
+        UInt16 keyLength;
+        std::memcpy(&keyLength, cursor + 1, sizeof(keyLength));
+        auto valueOffset = 1 + sizeof(keyLength) + keyLength;
+
+        UInt32 stringLength = 0;
+        if (type == LogFieldType::String) {
+            std::memcpy(&stringLength, cursor + valueOffset, sizeof(stringLength));
+        }
+
+        _offset += valueOffset + GetValueSize(type, stringLength);
+        return *this;
+    }
+
+    // MARK: -
+
+    LogFields::LogFields(std::initializer_list<LogField> fields) : LogFields() {
+        Add(fields);
+    }
+
+    LogFields::LogFields(const LogFields& other) : LogFields() {
+        *this = other;
+    }
+
+    LogFields::LogFields(LogFields&& other) noexcept : LogFields() {
+        *this = std::move(other);
+    }
+
+    LogFields& LogFields::operator=(const LogFields& other) {
+        if (this == &other) return *this;
+
+        Clear();
+        std::memcpy(Grow(other._size), other._data, other._size);
+        _count = other._count;
+        return *this;
+    }
+
+    LogFields& LogFields::operator=(LogFields&& other) noexcept {
+        if (this == &other) return *this;
+
+        if (other.IsInline()) {
+            // Nothing to steal, and the inline buffer is small
+            Clear();
+            std::memcpy(_data, other._data, other._size);
+            _size = other._size;
+        } else {
+            Reset();
+            _data = other._data;
+            _size = other._size;
+            _capacity = other._capacity;
+            other._data = other._inline;
+            other._capacity = InlineSize;
+        }
+
+        _count = other._count;
+        other.Clear();
+        return *this;
+    }
+
+    LogFields::~LogFields() {
+        if (!IsInline()) delete[] _data;
+    }
+
+    void LogFields::Reset() {
+        Clear();
+        if (IsInline()) return;
+
+        delete[] _data;
+        _data = _inline;
+        _capacity = InlineSize;
+    }
+
+    UInt8* LogFields::Grow(std::size_t size) {
+        auto required = _size + size;
+        if (required > _capacity) {
+            auto capacity = std::max(required, _capacity * 2);
+            auto data = new UInt8[capacity];
+            std::memcpy(data, _data, _size);
+            if (!IsInline()) delete[] _data;
+
+            _data = data;
+            _capacity = capacity;
+        }
+
+        auto cursor = _data + _size;
+        _size = required;
+        return cursor;
+    }
+
+    void LogFields::Add(const LogField& field) {
+        auto key = field.GetKey().substr(0, std::numeric_limits<UInt16>::max());
+        auto keyLength = (UInt16) key.size();
+
+        auto string = field.GetString().substr(0, std::numeric_limits<UInt32>::max());
+        auto cursor = Grow(1 + sizeof(keyLength) + keyLength + GetValueSize(field.GetType(), string.size()));
+
+        *cursor++ = (UInt8) field.GetType();
+        std::memcpy(cursor, &keyLength, sizeof(keyLength));
+        cursor += sizeof(keyLength);
+        std::memcpy(cursor, key.data(), keyLength);
+        cursor += keyLength;
+
+        switch (field.GetType()) {
+            case LogFieldType::Int64: {
+                auto value = field.GetInt64();
+                std::memcpy(cursor, &value, sizeof(value));
+                break;
+            }
+            case LogFieldType::UInt64: {
+                auto value = field.GetUInt64();
+                std::memcpy(cursor, &value, sizeof(value));
+                break;
+            }
+            case LogFieldType::Double: {
+                auto value = field.GetDouble();
+                std::memcpy(cursor, &value, sizeof(value));
+                break;
+            }
+            case LogFieldType::Bool:
+                *cursor = field.GetBool() ? 1 : 0;
+                break;
+            case LogFieldType::String: {
+                auto length = (UInt32) string.size();
+                std::memcpy(cursor, &length, sizeof(length));
+                std::memcpy(cursor + sizeof(length), string.data(), length);
+                break;
+            }
+        }
+
+        _count++;
+    }
+
+    void LogFields::Add(std::initializer_list<LogField> fields) {
+        for (auto &field : fields) {
+            Add(field);
+        }
+    }
+
+}
@@ -0,0 +1,145 @@
+//
+//  LogFormat.cpp
+//  Mochi
+//
+
+#include <Mochi/LogFormat.h>
+#include <charconv>
+#include <stdexcept>
+
+// Must match the definition in LogFormat.h
+#define __MC_INTERNAL __Intrnl_gst8190r4__
+
+namespace MOCHI_NAMESPACE {
+
+    void __MC_INTERNAL::InvalidLogFormatString(const char* reason) {
+        throw std::invalid_argument(reason);
+    }
+
+    // MARK: -
+
+    void LogArguments::EncodeString(Buffer& out, std::string_view value) {
+        auto length = (UInt32) value.size();
+        auto offset = out.size();
+        out.resize(offset + 1 + sizeof(length) + length);
+        out[offset] = (UInt8) LogArgumentType::String;
+        std::memcpy(out.data() + offset + 1, &length, sizeof(length));
+        std::memcpy(out.data() + offset + 1 + sizeof(length), value.data(), length);
+    }
+
+    void LogArguments::HashBytes(UInt64& hash, LogArgumentType type, const void* data, std::size_t size) {
+        // FNV-1a over the type, the length and the bytes, so adjacent arguments cannot alias
+        auto mix = [&](UInt8 byte) {
+            hash ^= byte;
+            hash *= 0x100000001b3;
+        };
+        
+        mix((UInt8) type);
+        for (std::size_t i = 0; i < sizeof(size); i++) {
+            mix((UInt8) (size >> (i * 8)));
+        }
+        
+        auto bytes = (const UInt8*) data;
+        for (std::size_t i = 0; i < size; i++) {
+            mix(bytes[i]);
+        }
+    }
+
+    // Appends the argument at `cursor` to `out` and advances past it.
+    // Returns false if the buffer is exhausted or malformed.
+    static Bool AppendArgument(std::span<const UInt8> arguments, std::size_t& cursor, std::string& out) {
+        auto read = [&](void* dst, std::size_t size) {
+            if (cursor + size > arguments.size()) return false;
+            std::memcpy(dst, arguments.data() + cursor, size);
+            cursor += size;
+            return true;
+        };
+        
+        UInt8 rawType;
+        if (!read(&rawType, 1)) return false;
+        
+        char buffer[32];
+        std::to_chars_result result{};
+        
+        switch ((LogArgumentType) rawType) {
+            case LogArgumentType::Int64: {
+                Int64 value;
+                if (!read(&value, sizeof(value))) return false;
+                result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                break;
+            }
+            case LogArgumentType::UInt64: {
+                UInt64 value;
+                if (!read(&value, sizeof(value))) return false;
+                result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                break;
+            }
+            case LogArgumentType::Double: {
+                double value;
+                if (!read(&value, sizeof(value))) return false;
+                result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                break;
+            }
+            case LogArgumentType::Bool: {
+                UInt8 value;
+                if (!read(&value, sizeof(value))) return false;
+                out += value ? "true" : "false";
+                return true;
+            }
+            case LogArgumentType::Char: {
+                char value;
+                if (!read(&value, sizeof(value))) return false;
+                out += value;
+                return true;
+            }
+            case LogArgumentType::String: {
+                UInt32 length;
+                if (!read(&length, sizeof(length))) return false;
+                if (cursor + length > arguments.size()) return false;
+                out.append((const char*) arguments.data() + cursor, length);
+                cursor += length;
+                return true;
+            }
+            case LogArgumentType::Pointer: {
+                UInt64 value;
+                if (!read(&value, sizeof(value))) return false;
+                out += "0x";
+                result = std::to_chars(buffer, buffer + sizeof(buffer), value, 16);
+                break;
+            }
+            default:
+                return false;
+        }
+        
+        out.append(buffer, result.ptr);
+        return true;
+    }
+
+    void LogArguments::Format(std::string_view format, std::span<const UInt8> arguments, std::string& out) {
+        std::size_t cursor = 0;
+        Bool exhausted = false;
+        
+        for (std::size_t i = 0; i < format.size(); i++) {
+            char c = format[i];
+            Bool hasNext = i + 1 < format.size();
+            
+            if ((c == '{' || c == '}') && hasNext && format[i + 1] == c) {
+                out += c;
+                i++;
+            } else if (c == '{' && hasNext && format[i + 1] == '}') {
+                // Keep the placeholder visible rather than dropping it if arguments run out
+                if (exhausted || !AppendArgument(arguments, cursor, out)) {
+                    exhausted = true;
+                    out += "{}";
+                }
+                
+                i++;
+            } else {
+                out += c;
+            }
+        }
+    }
+
+}
+
+#undef __MC_INTERNAL
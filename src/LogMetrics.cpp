@@ -0,0 +1,53 @@
+//
+//  LogMetrics.cpp
+//  Mochi
+//
+
+#include <Mochi/LogMetrics.h>
+#include <algorithm>
+#include <cmath>
+
+namespace MOCHI_NAMESPACE {
+
+    LatencyHistogram::LatencyHistogram() : _count(0), _sum(0), _max(0) {
+        for (auto &bucket : _counts) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    double LatencyHistogram::GetMean() const {
+        auto count = GetCount();
+        return count == 0 ? 0 : (double) _sum.load(std::memory_order_relaxed) / (double) count;
+    }
+
+    UInt64 LatencyHistogram::GetValueAtPercentile(double percentile) const {
+        // Buckets may be bumped while we read them, so rank against their own total
+        UInt64 total = 0;
+        for (auto &bucket : _counts) {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+
+        if (total == 0) return 0;
+
+        auto rank = (UInt64) std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * (double) total);
+        rank = std::max<UInt64>(rank, 1);
+
+        UInt64 seen = 0;
+        for (UInt32 i = 0; i < BucketCount; i++) {
+            seen += _counts[i].load(std::memory_order_relaxed);
+            if (seen >= rank) return std::min(GetBucketUpperBound(i), GetMax());
+        }
+
+        return GetMax();
+    }
+
+    UInt64 LatencyHistogram::GetBucketUpperBound(UInt32 index) {
+        if (index < SubBucketCount) return index;
+
+        auto shift = index / SubBucketCount - 1;
+        auto sub = (UInt64) (index % SubBucketCount);
+        auto lower = (SubBucketCount + sub) << shift;
+        return lower + ((UInt64) 1 << shift) - 1;
+    }
+
+}
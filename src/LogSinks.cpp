@@ -0,0 +1,813 @@
+//
+//  LogSinks.cpp
+//  Mochi
+//
+
+#include <Mochi/LogSinks.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+
+#if defined(_WIN32)
+#   include <io.h>
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#else
+#   include <climits>
+#   include <fcntl.h>
+#   include <sys/uio.h>
+#   include <unistd.h>
+#endif
+
+namespace MOCHI_NAMESPACE {
+
+    static void WriteVarInt(std::string& out, UInt64 value) {
+        while (value >= 0x80) {
+            out += (char) ((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+
+        out += (char) value;
+    }
+
+    static void WriteZigZag(std::string& out, Int64 value) {
+        WriteVarInt(out, ((UInt64) value << 1) ^ (UInt64) (value >> 63));
+    }
+
+    static void WriteString(std::string& out, std::string_view value) {
+        WriteVarInt(out, value.size());
+        out.append(value);
+    }
+
+    static Bool ReadVarInt(std::string_view& in, UInt64& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && !in.empty(); shift += 7) {
+            auto byte = (UInt8) in.front();
+            in.remove_prefix(1);
+            value |= (UInt64) (byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+
+        return false;
+    }
+
+    static Bool ReadZigZag(std::string_view& in, Int64& value) {
+        UInt64 raw;
+        if (!ReadVarInt(in, raw)) return false;
+        value = (Int64) (raw >> 1) ^ -(Int64) (raw & 1);
+        return true;
+    }
+
+    static Bool ReadString(std::string_view& in, std::string& value) {
+        UInt64 length;
+        if (!ReadVarInt(in, length) || length > in.size()) return false;
+        value.assign(in.substr(0, length));
+        in.remove_prefix(length);
+        return true;
+    }
+
+    static Int64 ToMicroseconds(std::chrono::time_point<std::chrono::system_clock> timestamp) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count();
+    }
+
+    // MARK: -
+
+    BinaryLogSink::BinaryLogSink(const std::string& path)
+    : _stream(path, std::ios::binary | std::ios::trunc), _lastTimestamp(0) {
+        if (!_stream) {
+            throw std::runtime_error("Cannot open binary log file: " + path);
+        }
+
+        _stream.write(Magic, sizeof(Magic));
+        _stream.put((char) Version);
+    }
+
+    BinaryLogSink::~BinaryLogSink() {
+        Flush();
+    }
+
+    std::future<void> BinaryLogSink::Invoke(Handle<LoggerEventArgs> ev) {
+        return InvokeBatch(LoggerEventBatch(&ev, 1));
+    }
+
+    std::future<void> BinaryLogSink::InvokeBatch(LoggerEventBatch events) {
+        for (auto &ev : events) {
+            Encode(*ev);
+        }
+
+        // One write per batch
+        _stream.write(_buffer.data(), (std::streamsize) _buffer.size());
+        _buffer.clear();
+        return Future::Completed();
+    }
+
+    std::future<void> BinaryLogSink::Flush() {
+        if (!_buffer.empty()) {
+            _stream.write(_buffer.data(), (std::streamsize) _buffer.size());
+            _buffer.clear();
+        }
+
+        _stream.flush();
+        return Future::Completed();
+    }
+
+    void BinaryLogSink::BeginRecord(BinaryLogRecordKind kind) {
+        _record.clear();
+        _record += (char) kind;
+    }
+
+    void BinaryLogSink::EndRecord() {
+        WriteVarInt(_buffer, _record.size());
+        _buffer += _record;
+    }
+
+    UInt32 BinaryLogSink::InternTag(std::string_view tag) {
+        auto it = _tags.find(tag);
+        if (it != _tags.end()) return it->second;
+
+        auto id = (UInt32) _tags.size() + 1;
+        _tags.emplace(std::string(tag), id);
+
+        BeginRecord(BinaryLogRecordKind::Tag);
+        WriteVarInt(_record, id);
+        WriteString(_record, tag);
+        EndRecord();
+        return id;
+    }
+
+    UInt32 BinaryLogSink::InternThread(std::thread::id threadId) {
+        auto it = _threads.find(threadId);
+        if (it != _threads.end()) return it->second;
+
+        auto id = (UInt32) _threads.size() + 1;
+        _threads.emplace(threadId, id);
+
+        std::stringstream str;
+        str << threadId;
+
+        BeginRecord(BinaryLogRecordKind::Thread);
+        WriteVarInt(_record, id);
+        WriteString(_record, str.str());
+        EndRecord();
+        return id;
+    }
+
+    void BinaryLogSink::Encode(const LoggerEventArgs& ev) {
+        UInt32 tagId;
+        if (ev.tagId != 0) {
+            if (ev.tagId >= _internedTags.size()) _internedTags.resize(ev.tagId + 1, 0);
+
+            auto &cached = _internedTags[ev.tagId];
+            if (cached == 0) {
+                _text.clear();
+                Component::AppendPlainText(ev.tag, _text);
+                cached = InternTag(_text);
+            }
+
+            tagId = cached;
+        } else {
+            _text.clear();
+            Component::AppendPlainText(ev.tag, _text);
+            tagId = InternTag(_text);
+        }
+
+        auto threadId = InternThread(ev.threadId);
+
+        auto timestamp = ToMicroseconds(ev.timestamp);
+        auto delta = timestamp - _lastTimestamp;
+        _lastTimestamp = timestamp;
+
+        _text.clear();
+        Component::AppendPlainText(ev.content, _text);
+
+        BeginRecord(BinaryLogRecordKind::Event);
+        WriteZigZag(_record, delta);
+        _record += (char) ev.level;
+        WriteVarInt(_record, tagId);
+        WriteVarInt(_record, threadId);
+        WriteString(_record, _text);
+        if (!ev.fields.IsEmpty()) EncodeFields(ev.fields);
+        EndRecord();
+    }
+
+    void BinaryLogSink::EncodeFields(const LogFields& fields) {
+        WriteVarInt(_record, fields.GetCount());
+
+        for (auto field : fields) {
+            WriteString(_record, field.GetKey());
+            _record += (char) field.GetType();
+
+            switch (field.GetType()) {
+                case LogFieldType::Int64:
+                    WriteZigZag(_record, field.GetInt64());
+                    break;
+                case LogFieldType::UInt64:
+                    WriteVarInt(_record, field.GetUInt64());
+                    break;
+                case LogFieldType::Double: {
+                    auto value = field.GetDouble();
+                    _record.append((const char*) &value, sizeof(value));
+                    break;
+                }
+                case LogFieldType::Bool:
+                    _record += (char) (field.GetBool() ? 1 : 0);
+                    break;
+                case LogFieldType::String:
+                    WriteString(_record, field.GetString());
+                    break;
+            }
+        }
+    }
+
+    static Bool ReadFields(std::string_view& in, LogFields& fields) {
+        UInt64 count;
+        if (!ReadVarInt(in, count)) return false;
+
+        std::string key;
+        std::string string;
+
+        for (UInt64 i = 0; i < count; i++) {
+            if (!ReadString(in, key) || in.empty()) return false;
+
+            auto type = (LogFieldType) in.front();
+            in.remove_prefix(1);
+
+            switch (type) {
+                case LogFieldType::Int64: {
+                    Int64 value;
+                    if (!ReadZigZag(in, value)) return false;
+                    fields.Add(key, value);
+                    break;
+                }
+                case LogFieldType::UInt64: {
+                    UInt64 value;
+                    if (!ReadVarInt(in, value)) return false;
+                    fields.Add(key, value);
+                    break;
+                }
+                case LogFieldType::Double: {
+                    double value;
+                    if (in.size() < sizeof(value)) return false;
+                    std::memcpy(&value, in.data(), sizeof(value));
+                    in.remove_prefix(sizeof(value));
+                    fields.Add(key, value);
+                    break;
+                }
+                case LogFieldType::Bool:
+                    if (in.empty()) return false;
+                    fields.Add(key, in.front() != 0);
+                    in.remove_prefix(1);
+                    break;
+                case LogFieldType::String:
+                    if (!ReadString(in, string)) return false;
+                    fields.Add(key, string);
+                    break;
+                default:
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    // MARK: -
+
+    static void AppendJsonString(std::string& out, std::string_view value) {
+        out += '"';
+
+        for (char c : value) {
+            switch (c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if ((UInt8) c < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", (int) c);
+                        out += escaped;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+
+        out += '"';
+    }
+
+    static void AppendJsonValue(std::string& out, const LogField& field) {
+        switch (field.GetType()) {
+            case LogFieldType::String:
+                AppendJsonString(out, field.GetString());
+                break;
+            case LogFieldType::Double:
+                // JSON has no NaN or infinity
+                if (!std::isfinite(field.GetDouble())) {
+                    out += "null";
+                    break;
+                }
+
+                field.AppendValue(out);
+                break;
+            default:
+                field.AppendValue(out);
+                break;
+        }
+    }
+
+    FileLogSink::FileLogSink(FileLogSinkOptions options)
+    : _options(std::move(options)), _chunkIndex(0), _buffered(0), _fileSize(0), _isRunning(true), _fd(-1) {
+        _chunks.resize(std::max<std::size_t>(1, (_options.bufferSize + ChunkSize - 1) / ChunkSize));
+        for (auto &chunk : _chunks) {
+            chunk.reserve(ChunkSize);
+        }
+
+        Open();
+
+        std::error_code error;
+        auto size = std::filesystem::file_size(_options.path, error);
+        _fileSize = error ? 0 : (std::size_t) size;
+        _openedAt = std::chrono::steady_clock::now();
+        _bufferedSince = _openedAt;
+        _writer = std::thread([this]() { RunWriter(); });
+    }
+
+    FileLogSink::FileLogSink(const std::string& path) : FileLogSink(FileLogSinkOptions { path }) {}
+
+    FileLogSink::~FileLogSink() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_buffered > 0) HandOff(false, false, nullptr);
+            _isRunning = false;
+        }
+
+        // The writer drains everything handed to it before it stops
+        _wakeWriter.notify_one();
+        _writer.join();
+        Close();
+    }
+
+    void FileLogSink::Open() {
+#if defined(_WIN32)
+        _fd = _open(_options.path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        _fd = open(_options.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+
+        if (_fd < 0) {
+            throw std::runtime_error("Cannot open log file " + _options.path + ": " + std::strerror(errno));
+        }
+    }
+
+    void FileLogSink::Close() {
+        if (_fd < 0) return;
+        if (_options.syncPolicy != FileSyncPolicy::Never) Sync();
+
+#if defined(_WIN32)
+        _close(_fd);
+#else
+        close(_fd);
+#endif
+
+        _fd = -1;
+    }
+
+    void FileLogSink::Sync() {
+#if defined(_WIN32)
+        _commit(_fd);
+#elif defined(__APPLE__)
+        fcntl(_fd, F_FULLFSYNC);
+#else
+        fdatasync(_fd);
+#endif
+    }
+
+    void FileLogSink::RotateFile() {
+        Close();
+
+        // Shift app.log.1 -> app.log.2 and so on, dropping the oldest one
+        std::error_code error;
+        auto rotated = [this](UInt32 index) {
+            return _options.path + "." + std::to_string(index);
+        };
+
+        if (_options.maxFiles == 0) {
+            std::filesystem::remove(_options.path, error);
+        } else {
+            std::filesystem::remove(rotated(_options.maxFiles), error);
+            for (UInt32 i = _options.maxFiles - 1; i >= 1; i--) {
+                std::filesystem::rename(rotated(i), rotated(i + 1), error);
+            }
+
+            std::filesystem::rename(_options.path, rotated(1), error);
+        }
+
+        Open();
+    }
+
+    void FileLogSink::Rotate() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        ThrowPendingError();
+        Submit(lock, true);
+    }
+
+    std::future<void> FileLogSink::Invoke(Handle<LoggerEventArgs> ev) {
+        return InvokeBatch(LoggerEventBatch(&ev, 1));
+    }
+
+    std::future<void> FileLogSink::InvokeBatch(LoggerEventBatch events) {
+        auto now = std::chrono::steady_clock::now();
+        Bool urgent = false;
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        ThrowPendingError();
+
+        // The writer only sets a deadline while something is buffered
+        auto wasEmpty = _buffered == 0;
+        if (wasEmpty) _bufferedSince = now;
+
+        for (auto &ev : events) {
+            Append(*ev, now, lock);
+            urgent |= ev->level >= _options.flushLevel;
+        }
+
+        if (urgent || (_buffered > 0 && now - _bufferedSince >= _options.flushInterval)) {
+            Submit(lock, false);
+        } else if (wasEmpty && _buffered > 0) {
+            _wakeWriter.notify_one();
+        }
+
+        return Future::Completed();
+    }
+
+    std::future<void> FileLogSink::Flush() {
+        auto written = CreateRef<std::promise<void>>();
+        auto future = written->get_future();
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        ThrowPendingError();
+        Submit(lock, false, _options.syncPolicy == FileSyncPolicy::OnFlush, std::move(written));
+        return future;
+    }
+
+    void FileLogSink::Append(const LoggerEventArgs& ev, SteadyTime now, std::unique_lock<std::mutex>& lock) {
+        _line.clear();
+        if (_options.format == FileLogFormat::JsonLines) {
+            FormatJson(ev);
+        } else {
+            FormatText(ev);
+        }
+
+        auto pending = _fileSize + _buffered;
+        Bool full = _options.maxFileSize > 0 && pending > 0 && pending + _line.size() > _options.maxFileSize;
+        Bool expired = _options.rotateInterval.count() > 0 && now - _openedAt >= _options.rotateInterval;
+        if (full || expired) {
+            Submit(lock, true);
+            _bufferedSince = now;
+        }
+
+        // Start a new chunk rather than splitting the line
+        if (!_chunks[_chunkIndex].empty() && _chunks[_chunkIndex].size() + _line.size() > ChunkSize) {
+            if (++_chunkIndex == _chunks.size()) {
+                _chunks.emplace_back().reserve(ChunkSize);
+            }
+        }
+
+        _chunks[_chunkIndex] += _line;
+        _buffered += _line.size();
+
+        if (_buffered >= _options.bufferSize) {
+            Submit(lock, false);
+            _bufferedSince = now;
+        }
+    }
+
+    void FileLogSink::FormatText(const LoggerEventArgs& ev) {
+        _timestamps.Append(_line, ev.timestamp);
+        _line += " [Thread@";
+        _line += GetThreadName(ev.threadId);
+        _line += "] [";
+        _line += GetLogLevelName(ev.level);
+        _line += "] [";
+        Component::AppendPlainText(ev.tag, _line);
+        _line += "] ";
+        Component::AppendPlainText(ev.content, _line);
+
+        for (auto field : ev.fields) {
+            _line += ' ';
+            _line += field.GetKey();
+            _line += '=';
+            field.AppendValue(_line);
+        }
+
+        _line += '\n';
+    }
+
+    void FileLogSink::FormatJson(const LoggerEventArgs& ev) {
+        _line += "{\"timestamp\":";
+        _line += std::to_string(ToMicroseconds(ev.timestamp));
+        _line += ",\"level\":";
+        AppendJsonString(_line, GetLogLevelName(ev.level));
+
+        _text.clear();
+        Component::AppendPlainText(ev.tag, _text);
+        _line += ",\"tag\":";
+        AppendJsonString(_line, _text);
+
+        _line += ",\"thread\":";
+        AppendJsonString(_line, GetThreadName(ev.threadId));
+
+        _text.clear();
+        Component::AppendPlainText(ev.content, _text);
+        _line += ",\"message\":";
+        AppendJsonString(_line, _text);
+
+        if (!ev.fields.IsEmpty()) {
+            _line += ",\"fields\":{";
+            Bool first = true;
+
+            for (auto field : ev.fields) {
+                if (!first) _line += ',';
+                first = false;
+
+                AppendJsonString(_line, field.GetKey());
+                _line += ':';
+                AppendJsonValue(_line, field);
+            }
+
+            _line += '}';
+        }
+
+        _line += "}\n";
+    }
+
+    const std::string& FileLogSink::GetThreadName(std::thread::id id) {
+        auto it = _threadNames.find(id);
+        if (it != _threadNames.end()) return it->second;
+
+        std::stringstream str;
+        str << id;
+        return _threadNames.emplace(id, str.str()).first->second;
+    }
+
+    void FileLogSink::Submit(std::unique_lock<std::mutex>& lock, Bool rotate,
+                             Bool sync, Handle<std::promise<void>> written) {
+        // Push back on the caller rather than buffering without bounds
+        _bufferWritten.wait(lock, [this]() {
+            return _pending.size() < MaxPendingBuffers || !_error.empty();
+        });
+
+        HandOff(rotate, sync, std::move(written));
+        _wakeWriter.notify_one();
+    }
+
+    void FileLogSink::HandOff(Bool rotate, Bool sync, Handle<std::promise<void>> written) {
+        auto &buffer = _pending.emplace_back();
+        buffer.rotate = rotate;
+        buffer.sync = sync;
+        buffer.written = std::move(written);
+
+        if (_buffered > 0) {
+            buffer.chunks.swap(_chunks);
+            if (_spareChunks.empty()) {
+                _chunks.resize(buffer.chunks.size());
+                for (auto &chunk : _chunks) {
+                    chunk.reserve(ChunkSize);
+                }
+            } else {
+                _chunks.swap(_spareChunks.back());
+                _spareChunks.pop_back();
+            }
+        }
+
+        _fileSize += _buffered;
+        _buffered = 0;
+        _chunkIndex = 0;
+
+        if (rotate) {
+            _fileSize = 0;
+            _openedAt = std::chrono::steady_clock::now();
+        }
+    }
+
+    void FileLogSink::HandOffExpired(SteadyTime now) {
+        Bool expired = _options.rotateInterval.count() > 0 && now - _openedAt >= _options.rotateInterval &&
+                       _fileSize + _buffered > 0;
+        if (expired || (_buffered > 0 && now - _bufferedSince >= _options.flushInterval)) {
+            HandOff(expired, false, nullptr);
+        }
+    }
+
+    void FileLogSink::ThrowPendingError() {
+        if (_error.empty()) return;
+
+        auto message = std::move(_error);
+        _error.clear();
+        throw std::runtime_error(message);
+    }
+
+    void FileLogSink::RunWriter() {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        for (;;) {
+            if (_pending.empty()) {
+                if (!_isRunning) return;
+
+                // Wake up in time for the oldest buffered line and for time-based rotation
+                auto deadline = SteadyTime::max();
+                if (_buffered > 0) {
+                    deadline = _bufferedSince + _options.flushInterval;
+                }
+
+                if (_options.rotateInterval.count() > 0 && _fileSize + _buffered > 0) {
+                    deadline = std::min(deadline, _openedAt + std::chrono::duration_cast<SteadyTime::duration>(_options.rotateInterval));
+                }
+
+                if (deadline == SteadyTime::max()) {
+                    _wakeWriter.wait(lock);
+                } else {
+                    _wakeWriter.wait_until(lock, deadline);
+                }
+
+                if (_pending.empty()) HandOffExpired(std::chrono::steady_clock::now());
+                continue;
+            }
+
+            auto buffer = std::move(_pending.front());
+            _pending.pop_front();
+            lock.unlock();
+
+            std::string error;
+            try {
+                Write(buffer.chunks);
+                if (buffer.sync || _options.syncPolicy == FileSyncPolicy::EveryWrite) Sync();
+                if (buffer.rotate) RotateFile();
+            } catch (std::exception &ex) {
+                error = ex.what();
+            }
+
+            if (buffer.written) buffer.written->set_value();
+
+            for (auto &chunk : buffer.chunks) {
+                chunk.clear();
+
+                // Give back the memory of oversized lines
+                if (chunk.capacity() > ChunkSize * 2) {
+                    std::string().swap(chunk);
+                    chunk.reserve(ChunkSize);
+                }
+            }
+
+            lock.lock();
+            if (!error.empty()) _error = std::move(error);
+            if (!buffer.chunks.empty()) _spareChunks.push_back(std::move(buffer.chunks));
+            _bufferWritten.notify_all();
+        }
+    }
+
+    void FileLogSink::Write(Chunks& chunks) {
+        if (_fd < 0) throw std::runtime_error("Cannot reopen log file " + _options.path);
+
+        // Chunks past the last one filled are empty
+        std::size_t count = 0;
+        while (count < chunks.size() && !chunks[count].empty()) count++;
+        std::size_t first = 0;
+        std::size_t offset = 0;
+        int error = 0;
+
+        while (first < count) {
+#if defined(_WIN32)
+            auto &chunk = chunks[first];
+            auto written = _write(_fd, chunk.data() + offset, (unsigned int) (chunk.size() - offset));
+#else
+            iovec vectors[64];
+            int vectorCount = 0;
+
+            for (auto i = first; i < count && vectorCount < std::min(64, IOV_MAX); i++) {
+                auto &chunk = chunks[i];
+                auto skip = i == first ? offset : 0;
+                vectors[vectorCount].iov_base = chunk.data() + skip;
+                vectors[vectorCount].iov_len = chunk.size() - skip;
+                vectorCount++;
+            }
+
+            auto written = writev(_fd, vectors, vectorCount);
+#endif
+
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                error = errno;
+                break;
+            }
+
+            // Skip over whatever was written, which may end in the middle of a chunk
+            auto remaining = (std::size_t) written;
+            while (first < count && remaining >= chunks[first].size() - offset) {
+                remaining -= chunks[first].size() - offset;
+                offset = 0;
+                first++;
+            }
+
+            offset += remaining;
+        }
+
+        if (error != 0) {
+            throw std::runtime_error("Cannot write log file " + _options.path + ": " + std::strerror(error));
+        }
+    }
+
+    // MARK: -
+
+    BinaryLogDecoder::BinaryLogDecoder(std::istream& stream) : _stream(stream), _lastTimestamp(0) {
+        char magic[sizeof(BinaryLogSink::Magic)];
+        if (!_stream.read(magic, sizeof(magic)) ||
+            !std::equal(magic, magic + sizeof(magic), BinaryLogSink::Magic)) {
+            throw std::runtime_error("Not a binary log file.");
+        }
+
+        auto version = _stream.get();
+        if (version != BinaryLogSink::Version) {
+            throw std::runtime_error("Unsupported binary log version: " + std::to_string(version));
+        }
+    }
+
+    Bool BinaryLogDecoder::Next(DecodedLogRecord& out) {
+        for (;;) {
+            // Records are prefixed with their length as a varint
+            UInt64 length = 0;
+            int shift = 0;
+            int byte;
+
+            while ((byte = _stream.get()) != EOF) {
+                length |= (UInt64) (byte & 0x7f) << shift;
+                shift += 7;
+                if (!(byte & 0x80) || shift >= 64) break;
+            }
+
+            if (byte == EOF) {
+                if (shift == 0) return false;
+                throw std::runtime_error("Truncated record length.");
+            }
+
+            _record.resize(length);
+            if (!_stream.read(_record.data(), (std::streamsize) length)) {
+                throw std::runtime_error("Truncated record.");
+            }
+
+            std::string_view in = _record;
+            if (in.empty()) throw std::runtime_error("Empty record.");
+
+            auto kind = (BinaryLogRecordKind) in.front();
+            in.remove_prefix(1);
+
+            UInt64 id;
+            std::string name;
+
+            switch (kind) {
+                case BinaryLogRecordKind::Tag:
+                    if (!ReadVarInt(in, id) || !ReadString(in, name)) throw std::runtime_error("Corrupted tag record.");
+                    _tags[(UInt32) id] = std::move(name);
+                    continue;
+
+                case BinaryLogRecordKind::Thread:
+                    if (!ReadVarInt(in, id) || !ReadString(in, name)) throw std::runtime_error("Corrupted thread record.");
+                    _threads[(UInt32) id] = std::move(name);
+                    continue;
+
+                case BinaryLogRecordKind::Event: {
+                    Int64 delta;
+                    UInt64 tagId, threadId;
+
+                    if (!ReadZigZag(in, delta) || in.empty()) throw std::runtime_error("Corrupted event record.");
+                    out.level = (LogLevel) (UInt8) in.front();
+                    in.remove_prefix(1);
+
+                    if (!ReadVarInt(in, tagId) || !ReadVarInt(in, threadId) || !ReadString(in, out.text)) {
+                        throw std::runtime_error("Corrupted event record.");
+                    }
+
+                    out.fields.Clear();
+                    if (!in.empty() && !ReadFields(in, out.fields)) {
+                        throw std::runtime_error("Corrupted event fields.");
+                    }
+
+                    _lastTimestamp += delta;
+                    out.timestamp = std::chrono::time_point<std::chrono::system_clock>(
+                        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::microseconds(_lastTimestamp)));
+                    out.tag = _tags[(UInt32) tagId];
+                    out.thread = _threads[(UInt32) threadId];
+                    return true;
+                }
+
+                default:
+                    // Unknown records from newer writers are skipped
+                    continue;
+            }
+        }
+    }
+
+}
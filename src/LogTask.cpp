@@ -0,0 +1,175 @@
+//
+//  LogTask.cpp
+//  Mochi
+//
+
+#include <Mochi/LogTask.h>
+#include <utility>
+#include <vector>
+
+namespace MOCHI_NAMESPACE {
+
+    // Coroutine frames of a given handler all have the same size, so a small free list per
+    // size class is enough to stop allocating once the handler has run a few times. Frames
+    // freed on another thread go to that thread's list.
+    struct LogTaskFrameCache {
+        static constexpr std::size_t Granularity = 64;
+        static constexpr std::size_t ClassCount = 16;
+        static constexpr std::size_t MaxCachedFrames = 64;
+
+        std::vector<void*> frames[ClassCount];
+
+        LogTaskFrameCache() {
+            for (auto &list : frames) {
+                list.reserve(MaxCachedFrames);
+            }
+        }
+
+        ~LogTaskFrameCache();
+    };
+
+    // Frames freed while the thread is exiting bypass the cache
+    static thread_local Bool s_frameCacheDestroyed = false;
+    static thread_local LogTaskFrameCache s_frameCache;
+
+    LogTaskFrameCache::~LogTaskFrameCache() {
+        s_frameCacheDestroyed = true;
+
+        for (auto &list : frames) {
+            for (auto frame : list) {
+                ::operator delete(frame);
+            }
+        }
+    }
+
+    void* LogTask::promise_type::operator new(std::size_t size) {
+        auto index = (size - 1) / LogTaskFrameCache::Granularity;
+        if (index >= LogTaskFrameCache::ClassCount) {
+            return ::operator new(size);
+        }
+
+        // Even frames that bypass the cache get the full size of their class, since they may
+        // be freed into the cache of another thread and handed out for any size in the class
+        auto classSize = (index + 1) * LogTaskFrameCache::Granularity;
+        if (s_frameCacheDestroyed) {
+            return ::operator new(classSize);
+        }
+
+        auto &list = s_frameCache.frames[index];
+        if (!list.empty()) {
+            auto frame = list.back();
+            list.pop_back();
+            return frame;
+        }
+
+        return ::operator new(classSize);
+    }
+
+    void LogTask::promise_type::operator delete(void* frame, std::size_t size) {
+        auto index = (size - 1) / LogTaskFrameCache::Granularity;
+        if (index >= LogTaskFrameCache::ClassCount || s_frameCacheDestroyed) {
+            ::operator delete(frame);
+            return;
+        }
+
+        auto &list = s_frameCache.frames[index];
+        if (list.size() < LogTaskFrameCache::MaxCachedFrames) {
+            list.push_back(frame);
+        } else {
+            ::operator delete(frame);
+        }
+    }
+
+    void LogTask::promise_type::unhandled_exception() {
+        try {
+            throw;
+        } catch (std::exception &ex) {
+            std::cout << "Exception: " << ex.what() << "\n";
+        } catch (...) {
+            std::cout << "Exception: (unknown)\n";
+        }
+    }
+
+    // MARK: -
+
+    void LogTask::Detach(std::atomic<std::size_t>* pending) {
+        auto handle = std::exchange(_handle, nullptr);
+        if (!handle) return;
+
+        // Most handlers finish without suspending; leave the counter alone for those
+        auto &promise = handle.promise();
+        if (promise._state.load(std::memory_order_acquire) == Done) {
+            handle.destroy();
+            return;
+        }
+
+        if (pending) pending->fetch_add(1, std::memory_order_relaxed);
+        promise._pending = pending;
+
+        auto expected = Running;
+        if (!promise._state.compare_exchange_strong(expected, Detached, std::memory_order_acq_rel)) {
+            // It already finished, so it is ours to destroy
+            handle.destroy();
+            if (pending) Release(pending);
+        }
+    }
+
+    void LogTask::Finish(std::coroutine_handle<promise_type> handle) noexcept {
+        auto &promise = handle.promise();
+        if (promise._state.exchange(Done, std::memory_order_acq_rel) != Detached) return;
+
+        // Nobody holds the task any more: clean up after ourselves
+        auto pending = promise._pending;
+        handle.destroy();
+        if (pending) Release(pending);
+    }
+
+    void LogTask::Release(std::atomic<std::size_t>* pending) noexcept {
+        if (pending->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            pending->notify_all();
+        }
+    }
+
+    // MARK: -
+
+    Handle<IAsyncLogEventDelegate> LogTaskDelegate::Create(Signature handler) {
+        return Handle<LogTaskDelegate>(new LogTaskDelegate(std::move(handler), nullptr));
+    }
+
+    Handle<IAsyncLogEventDelegate> LogTaskDelegate::CreateBatched(BatchSignature handler) {
+        return Handle<LogTaskDelegate>(new LogTaskDelegate(nullptr, std::move(handler)));
+    }
+
+    std::future<void> LogTaskDelegate::Invoke(Handle<LoggerEventArgs> ev) {
+        return InvokeBatch(LoggerEventBatch(&ev, 1));
+    }
+
+    std::future<void> LogTaskDelegate::InvokeBatch(LoggerEventBatch events) {
+        Deliver(events);
+        return Flush();
+    }
+
+    void LogTaskDelegate::Deliver(LoggerEventBatch events) {
+        if (_batchHandler) {
+            _batchHandler(events).Detach(&_pending);
+            return;
+        }
+
+        for (auto &ev : events) {
+            _handler(ev).Detach(&_pending);
+        }
+    }
+
+    std::future<void> LogTaskDelegate::Flush() {
+        WaitPending();
+        return Future::Completed();
+    }
+
+    void LogTaskDelegate::WaitPending() {
+        for (auto pending = _pending.load(std::memory_order_acquire); pending != 0;
+             pending = _pending.load(std::memory_order_acquire)) {
+            _pending.wait(pending, std::memory_order_acquire);
+        }
+    }
+
+}
@@ -6,6 +6,10 @@
 //
 
 #include <Mochi/Logging.h>
+#include <Mochi/LogCrashRing.h>
+#include <algorithm>
+#include <map>
+#include <set>
 
 namespace MOCHI_NAMESPACE {
 
@@ -52,6 +56,19 @@ namespace MOCHI_NAMESPACE {
     //    return false;
     }
 
+    TextColor::Ref GetLogLevelColor(LogLevel level) {
+        switch (level) {
+            case LogLevel::Verbose: return TextColor::DarkGray;
+            case LogLevel::Log:     return TextColor::Gray;
+            case LogLevel::Info:    return TextColor::Green;
+            case LogLevel::Warn:    return TextColor::Gold;
+            case LogLevel::Error:   return TextColor::Red;
+            case LogLevel::Fatal:   return TextColor::DarkRed;
+        }
+        
+        return TextColor::Gray;
+    }
+
     // MARK: -
 
     std::shared_ptr<IAsyncLogEventDelegate> IAsyncLogEventDelegate::Create(IAsyncLogEventDelegate::Signature delegate) {
@@ -71,24 +88,396 @@ namespace MOCHI_NAMESPACE {
         return std::make_shared<Instance>(delegate);
     }
 
+    std::shared_ptr<IAsyncLogEventDelegate> IAsyncLogEventDelegate::CreateBatched(IAsyncLogEventDelegate::BatchSignature delegate) {
+        class Instance : public IAsyncLogEventDelegate {
+        private:
+            IAsyncLogEventDelegate::BatchSignature _d;
+        public:
+            Instance(IAsyncLogEventDelegate::BatchSignature d) : _d(d) {
+                
+            }
+            
+            std::future<void> Invoke(std::shared_ptr<LoggerEventArgs> ev) override {
+                return _d(LoggerEventBatch(&ev, 1));
+            }
+            
+            std::future<void> InvokeBatch(LoggerEventBatch events) override {
+                return _d(events);
+            }
+        };
+        
+        return std::make_shared<Instance>(delegate);
+    }
+
+    std::future<void> IAsyncLogEventDelegate::InvokeBatch(LoggerEventBatch events) {
+        std::vector<std::future<void>> tasks;
+        tasks.reserve(events.size());
+        
+        for (auto &ev : events) {
+            tasks.push_back(Invoke(ev));
+        }
+        
+        return Future::WhenAll(tasks);
+    }
+
+    void IAsyncLogEventDelegate::Deliver(LoggerEventBatch events) {
+        if (events.size() == 1) {
+            Invoke(events.front());
+        } else {
+            InvokeBatch(events);
+        }
+    }
+
+    std::future<void> IAsyncLogEventDelegate::Flush() {
+        return Future::Completed();
+    }
+
+    // MARK: -
+
+    static std::mutex& GetCallSiteRegistryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::vector<const LogCallSite*>& GetCallSiteRegistry() {
+        static std::vector<const LogCallSite*> registry;
+        return registry;
+    }
+
+    void LogCallSite::Bind(std::string_view format) {
+        if (GetId() != 0) return;
+        LogCallSites::Register(*this, format);
+    }
+
+    UInt32 LogCallSites::Register(LogCallSite& site, std::string_view format) {
+        std::lock_guard<std::mutex> lock(GetCallSiteRegistryMutex());
+        
+        // Another thread may have won the race to register this site
+        if (auto id = site._id.load(std::memory_order_relaxed)) return id;
+        
+        auto& registry = GetCallSiteRegistry();
+        registry.push_back(&site);
+        
+        auto id = (UInt32) registry.size();
+        site._format = format;
+        site._id.store(id, std::memory_order_release);
+        return id;
+    }
+
+    const LogCallSite* LogCallSites::Get(UInt32 id) {
+        std::lock_guard<std::mutex> lock(GetCallSiteRegistryMutex());
+        auto& registry = GetCallSiteRegistry();
+        if (id == 0 || id > registry.size()) return nullptr;
+        return registry[id - 1];
+    }
+
+    std::vector<const LogCallSite*> LogCallSites::GetAll() {
+        std::lock_guard<std::mutex> lock(GetCallSiteRegistryMutex());
+        return GetCallSiteRegistry();
+    }
+
+    // MARK: -
+
+    struct LogTagRegistry {
+        std::mutex mutex;
+        std::map<std::string, UInt32, std::less<>> ids;
+        std::vector<LogTag> tags;
+    };
+
+    static LogTagRegistry& GetLogTagRegistry() {
+        static LogTagRegistry registry;
+        return registry;
+    }
+
+    LogTag LogTags::Intern(std::string_view name) {
+        auto& registry = GetLogTagRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        
+        auto it = registry.ids.find(name);
+        if (it != registry.ids.end()) return registry.tags[it->second - 1];
+        
+        auto id = (UInt32) registry.tags.size() + 1;
+        registry.tags.push_back(LogTag { Component::Literal(std::string(name)), id });
+        registry.ids.emplace(std::string(name), id);
+        return registry.tags.back();
+    }
+
+    LogTag LogTags::Get(UInt32 id) {
+        auto& registry = GetLogTagRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (id == 0 || id > registry.tags.size()) return LogTag();
+        return registry.tags[id - 1];
+    }
+
+    // MARK: -
+
+    // The registry is reached through functions so that NamedLoggers living in other
+    // translation units can safely register during static initialization.
+    static std::mutex& GetNamedLoggerRegistryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::set<NamedLogger*>& GetNamedLoggerRegistry() {
+        static std::set<NamedLogger*> registry;
+        return registry;
+    }
+
+    // MARK: -
+
+    LoggerEventPool::LoggerEventPool(std::size_t capacity) : _free(capacity) {}
+
+    Handle<LoggerEventPool::Entry> LoggerEventPool::CreateEntry() {
+        auto entry = std::make_shared<Entry>();
+        entry->ownContent = Component::Literal("");
+        entry->ownTag = Component::Literal("");
+        entry->contentText = CastRef<LiteralContent>(entry->ownContent->GetContent());
+        entry->tagText = CastRef<LiteralContent>(entry->ownTag->GetContent());
+        entry->content = entry->ownContent;
+        entry->tag = entry->ownTag;
+        return entry;
+    }
+
+    void LoggerEventPool::ResetText(std::string& text) {
+        if (text.capacity() > MaxRetainedTextSize) {
+            std::string().swap(text);
+        } else {
+            text.clear();
+        }
+    }
+
+    Handle<LoggerEventPool::Entry> LoggerEventPool::TakeEntry(LogLevel level, Handle<TextColor> color) {
+        Handle<Entry> entry;
+        if (!_free.TryDequeue(entry)) {
+            entry = CreateEntry();
+        }
+        
+        entry->level = level;
+        entry->color = std::move(color);
+        entry->threadId = std::this_thread::get_id();
+        entry->timestamp = LogClock::Now();
+        return entry;
+    }
+
+    Handle<LoggerEventArgs> LoggerEventPool::Acquire(LogLevel level,
+                                                     std::string_view text,
+                                                     Handle<TextColor> color,
+                                                     std::string_view tag) {
+        auto entry = TakeEntry(level, std::move(color));
+        entry->contentText->text.assign(text);
+        entry->tagText->text.assign(tag);
+        return entry;
+    }
+
+    Handle<LoggerEventArgs> LoggerEventPool::Acquire(LogLevel level,
+                                                     std::string_view text,
+                                                     Handle<TextColor> color,
+                                                     const LogTag& tag) {
+        auto entry = TakeEntry(level, std::move(color));
+        entry->contentText->text.assign(text);
+        entry->tag = tag.component;
+        entry->tagId = tag.id;
+        return entry;
+    }
+
+    Handle<LoggerEventArgs> LoggerEventPool::Acquire(LogLevel level,
+                                                     Handle<IComponent> content,
+                                                     Handle<TextColor> color,
+                                                     Handle<IComponent> tag) {
+        auto entry = TakeEntry(level, std::move(color));
+        entry->content = std::move(content);
+        entry->tag = std::move(tag);
+        return entry;
+    }
+
+    void LoggerEventPool::FormatPending(const Handle<LoggerEventArgs>& event) {
+        auto entry = static_cast<Entry*>(event.get());
+        if (!entry->hasPendingFormat) return;
+        
+        if (auto site = entry->site) {
+            if (!entry->color) entry->color = GetLogLevelColor(entry->level);
+            if (!entry->hasTagOverride) entry->tagText->text.assign(site->tag);
+            entry->format = site->GetFormat();
+        }
+        
+        
+        entry->hasPendingFormat = false;
+        LogArguments::Format(entry->format, entry->arguments, entry->contentText->text);
+    }
+
+    void LoggerEventPool::Release(Handle<LoggerEventArgs>& event) {
+        auto entry = std::static_pointer_cast<Entry>(std::move(event));
+        if (entry.use_count() != 1) return;
+        
+        // A handler holding on to a component (or its content) would see the text change
+        // under its feet, so such events are left to be freed normally.
+        auto expectedUses = [](const IComponent::Ref& own, const IComponent::Ref& current) {
+            return own == current ? 2 : 1;
+        };
+        
+        if (entry->ownContent.use_count() != expectedUses(entry->ownContent, entry->content)) return;
+        if (entry->ownTag.use_count() != expectedUses(entry->ownTag, entry->tag)) return;
+        if (entry->contentText.use_count() != 2 || entry->tagText.use_count() != 2) return;
+        
+        ResetText(entry->contentText->text);
+        ResetText(entry->tagText->text);
+        entry->format = std::string_view();
+        entry->site = nullptr;
+        entry->hasPendingFormat = false;
+        entry->hasTagOverride = false;
+        entry->tagId = 0;
+        if (entry->fields.GetCapacity() > MaxRetainedTextSize) {
+            entry->fields.Reset();
+        } else {
+            entry->fields.Clear();
+        }
+        if (entry->arguments.capacity() > MaxRetainedTextSize) {
+            LogArguments::Buffer().swap(entry->arguments);
+        } else {
+            entry->arguments.clear();
+        }
+        entry->content = entry->ownContent;
+        entry->tag = entry->ownTag;
+        entry->color = nullptr;
+        
+        // Let the entry be freed if the pool is already full
+        _free.TryEnqueue(std::move(entry));
+    }
+
+    // MARK: -
+
+    LogSinkWorker::LogSinkWorker(Handle<IAsyncLogEventDelegate> handler, Handle<LogSinkMetrics> metrics)
+    : _handler(std::move(handler)), _metrics(std::move(metrics)), _queue(QueueCapacity), _idleWaiter(WaitStrategy::SpinThenPark), _isRunning(true) {
+        _batch.reserve(MaxBatchSize);
+        _thread = std::thread([this]() { Run(); });
+    }
+
+    LogSinkWorker::~LogSinkWorker() {
+        Stop();
+    }
+
+    void LogSinkWorker::Post(Handle<LoggerEventArgs> event) {
+        Post(Record { std::move(event), nullptr });
+    }
+
+    void LogSinkWorker::PostFlush(std::function<void()> done) {
+        Post(Record { nullptr, [this, done = std::move(done)]() {
+            try {
+                _handler->Flush().wait();
+            } catch (std::exception &ex) {
+                std::cout << "Exception: " << ex.what() << "\n";
+            }
+            
+            done();
+        } });
+    }
+
+    void LogSinkWorker::Post(Record record) {
+        // Wait for the worker to catch up rather than dropping anything
+        while (!_queue.TryEnqueue(std::move(record))) {
+            std::this_thread::yield();
+        }
+        
+        _idleWaiter.Notify();
+    }
+
+    void LogSinkWorker::Stop() {
+        if (!_thread.joinable()) return;
+        
+        _isRunning = false;
+        _idleWaiter.Wake();
+        _thread.join();
+    }
+
+    void LogSinkWorker::Run() {
+        Record record;
+        
+        for (;;) {
+            _idleWaiter.Wait([this]() {
+                return !_isRunning || !_queue.IsEmpty();
+            });
+            
+            Bool drained = false;
+            while (!drained) {
+                drained = true;
+                
+                while (_queue.TryDequeue(record)) {
+                    if (record.event) {
+                        _batch.push_back(std::move(record.event));
+                        if (_batch.size() < MaxBatchSize) continue;
+                        
+                        InvokeBatch();
+                        drained = false;
+                        break;
+                    }
+                    
+                    // Hooks run after every event posted before them
+                    InvokeBatch();
+                    record.action();
+                    record.action = nullptr;
+                }
+                
+                InvokeBatch();
+            }
+            
+            if (!_isRunning && _queue.IsEmpty()) return;
+        }
+    }
+
+    void LogSinkWorker::InvokeBatch() {
+        if (_batch.empty()) return;
+        
+        auto start = std::chrono::steady_clock::now();
+        try {
+            _handler->Deliver(_batch);
+        } catch (std::exception &ex) {
+            std::cout << "Exception: " << ex.what() << "\n";
+        }
+        
+        _metrics->Record(_batch.size(), std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        
+        // Dropping our references lets the logger thread recycle the events
+        _batch.clear();
+    }
+
     // MARK: -
 
-    Logger::HandlerRef Logger::_loggedHandler = std::make_unique<Logger::Handler>();
-    Logger::RecordCall Logger::_recordCall = std::queue<std::function<void()>>();
-    std::mutex Logger::_recordCallMutex = std::mutex();
-    Bool Logger::_bootstrapped = false;
-    Bool Logger::_isRunning = false;
     Bool Logger::_isInitialized = false;
-    std::thread::id Logger::_threadId = std::this_thread::get_id();
-    std::shared_ptr<std::thread> Logger::_thread = std::shared_ptr<std::thread>();
 
-    void Logger::RunEventLoop() {
-        _isRunning = true;
+    void Logger::Init() {
+        if (_isInitialized) {
+            throw std::runtime_error("Logger already initialized.");
+        }
         
+        _isInitialized = true;
+        LogPipeline::GetDefault();
+    }
+
+    // MARK: -
+
+    LogPipeline::LogPipeline(std::size_t queueCapacity)
+    : _loggedHandler(std::make_unique<Handler>()), _recordCall(queueCapacity), _bootstrapped(false), _isRunning(false),
+      _threadId(), _eventPool(queueCapacity), _dispatched(0), _queueHighWater(0),
+      _minimumLevel(LogLevel::Verbose), _queueFullPolicy(QueueFullPolicy::Block), _sampleLevel(LogLevel::Warn),
+      _sampleCounter(0), _droppedEvents(), _droppedTotal(0), _reportedDrops(), _reportedTotal(0) {
+        _pollBatch.reserve(MaxBatchSize);
+        _eventBatch.reserve(MaxBatchSize);
+    }
+
+    LogPipeline::~LogPipeline() {
+        Join();
+        
+        for (auto &worker : _sinkWorkers) {
+            worker->Stop();
+        }
+    }
+
+    void LogPipeline::RunEventLoop() {
         while (_isRunning) {
-            while (_isRunning && _recordCall.empty()) {
-                std::this_thread::yield();
-            }
+            _idleWaiter.Wait([this]() {
+                return !_isRunning || !_recordCall.IsEmpty();
+            });
             
             PollEvents();
         }
@@ -97,212 +486,734 @@ namespace MOCHI_NAMESPACE {
         PollEvents();
     }
 
-    void Logger::CallOrQueue(std::function<void()> action) {
+    void LogPipeline::Enqueue(RecordCall record) {
+        if (record.event && _queueFullPolicy.load(std::memory_order_relaxed) == QueueFullPolicy::SampleLowLevels &&
+            record.event->level < _sampleLevel.load(std::memory_order_relaxed) &&
+            _recordCall.GetSize() >= _recordCall.GetCapacity() / 4 * 3 &&
+            _sampleCounter.fetch_add(1, std::memory_order_relaxed) % SampleRate != 0) {
+            DropEvent(record.event);
+            return;
+        }
+        
+        // The queue is bounded, so either wait for the logger thread to free up a cell
+        // or drop something, depending on the policy. Hooks are never dropped.
+        while (!_recordCall.TryEnqueue(std::move(record))) {
+            if (!TryMakeRoom(record)) return;
+        }
+        
+        _idleWaiter.Notify();
+    }
+
+    Bool LogPipeline::TryMakeRoom(RecordCall& record) {
+        auto policy = record.event ? _queueFullPolicy.load(std::memory_order_relaxed) : QueueFullPolicy::Block;
+        
+        switch (policy) {
+            case QueueFullPolicy::DropNewest:
+                DropEvent(record.event);
+                return false;
+                
+            case QueueFullPolicy::SampleLowLevels:
+                if (record.event->level < _sampleLevel.load(std::memory_order_relaxed)) {
+                    DropEvent(record.event);
+                    return false;
+                }
+                
+                break;
+                
+            case QueueFullPolicy::DropOldest: {
+                // Hooks have to run, so those found at the front are queued again behind the
+                // newer records, which moves them after those (see QueueFullPolicy::DropOldest).
+                // After a whole queue of them, wait like Block instead.
+                for (std::size_t i = 0; i < _recordCall.GetCapacity(); i++) {
+                    RecordCall oldest;
+                    if (!_recordCall.TryDequeue(oldest)) return true;
+                    
+                    if (oldest.event) {
+                        DropEvent(oldest.event);
+                        return true;
+                    }
+                    
+                    // Another producer may have taken the cell in the meantime
+                    while (!_recordCall.TryEnqueue(std::move(oldest))) {
+                        std::this_thread::yield();
+                    }
+                }
+                
+                break;
+            }
+                
+            default:
+                break;
+        }
+        
+        std::this_thread::yield();
+        return true;
+    }
+
+    void LogPipeline::DropEvent(Handle<LoggerEventArgs>& event) {
+        _droppedEvents[(std::size_t) event->level].fetch_add(1, std::memory_order_relaxed);
+        _droppedTotal.fetch_add(1, std::memory_order_relaxed);
+        _eventPool.Release(event);
+    }
+
+    void LogPipeline::ReportDroppedEvents() {
+        auto total = _droppedTotal.load(std::memory_order_relaxed);
+        if (total == _reportedTotal) return;
+        
+        // Wait until the pressure subsides, or the report would only add to it
+        if (_recordCall.GetSize() > _recordCall.GetCapacity() / 4) return;
+        _reportedTotal = total;
+        
+        UInt64 dropped = 0;
+        std::string details;
+        
+        for (std::size_t i = 0; i <= (std::size_t) LogLevel::Fatal; i++) {
+            auto count = _droppedEvents[i].load(std::memory_order_relaxed);
+            auto delta = count - _reportedDrops[i];
+            _reportedDrops[i] = count;
+            if (delta == 0) continue;
+            
+            dropped += delta;
+            if (!details.empty()) details += ", ";
+            details += GetLogLevelName((LogLevel) i) + ": " + std::to_string(delta);
+        }
+        
+        if (dropped == 0) return;
+        LogText(LogLevel::Warn,
+                "Dropped " + std::to_string(dropped) + " events because the queue was full (" + details + ").",
+                TextColor::Gold, "Logger");
+    }
+
+    void LogPipeline::SetQueueFullPolicy(QueueFullPolicy policy, LogLevel sampleLevel) {
+        _sampleLevel.store(sampleLevel, std::memory_order_relaxed);
+        _queueFullPolicy.store(policy, std::memory_order_relaxed);
+    }
+
+    QueueFullPolicy LogPipeline::GetQueueFullPolicy() const {
+        return _queueFullPolicy.load(std::memory_order_relaxed);
+    }
+
+    UInt64 LogPipeline::GetDroppedCount() const {
+        return _droppedTotal.load(std::memory_order_relaxed);
+    }
+
+    UInt64 LogPipeline::GetDroppedCount(LogLevel level) const {
+        return _droppedEvents[(std::size_t) level].load(std::memory_order_relaxed);
+    }
+
+    void LogPipeline::CallOrQueue(RecordCall record) {
         if (!_bootstrapped) {
             RunThreaded();
             
-            auto current = std::chrono::system_clock::now();
-            
-            InternalOnLogged(std::make_shared<LoggerEventArgs>(LoggerEventArgs{
-                LogLevel::Warn,
-                Component::Literal("*** Logger is not bootstrapped. ***"),
-                Component::Literal("Logger"),
-                TextColor::Gold,
-                std::this_thread::get_id(),
-                current
-            }));
-            
-            InternalOnLogged(std::make_shared<LoggerEventArgs>(LoggerEventArgs{
-                LogLevel::Warn,
-                Component::Literal("Logger now requires either RunThreaded(), RunBlocking() or RunManualPoll() to poll log events."),
-                Component::Literal("Logger"),
-                TextColor::Gold,
-                std::this_thread::get_id(),
-                current
-            }));
-            
-            InternalOnLogged(std::make_shared<LoggerEventArgs>(LoggerEventArgs {
-                LogLevel::Warn,
-                Component::Literal("The threaded approach will be used by default."),
-                Component::Literal("Logger"),
-                TextColor::Gold,
-                std::this_thread::get_id(),
-                current
-            }));
+            for (auto text : {
+                "*** Logger is not bootstrapped. ***",
+                "Logger now requires either RunThreaded(), RunBlocking() or RunManualPoll() to poll log events.",
+                "The threaded approach will be used by default."
+            }) {
+                InternalOnLogged(_eventPool.Acquire(LogLevel::Warn, text, TextColor::Gold, "Logger"));
+            }
         }
         
         if (!_bootstrapped) {
             throw std::runtime_error("Logger is not bootstrapped.");
         }
         
-        std::lock_guard<std::mutex> lock(_recordCallMutex);
-        if (std::this_thread::get_id() != _threadId) {
-            _recordCall.push(action);
+        if (_crashRing && record.event) {
+            // Every event of the pipeline comes from its pool
+            _crashRing->Write(static_cast<const LoggerEventPool::Entry&>(*record.event));
+        }
+        
+        if (std::this_thread::get_id() != _threadId.load(std::memory_order_relaxed)) {
+            Enqueue(std::move(record));
+        } else if (record.event) {
+            _eventPool.FormatPending(record.event);
+            RecordDispatch(LoggerEventBatch(&record.event, 1));
+            InternalOnLogged(record.event);
+            ReleaseEvent(record.event);
         } else {
-            action();
+            record.action();
+        }
+    }
+
+    void LogPipeline::InternalOnLogged(std::shared_ptr<LoggerEventArgs> data) {
+        for (LogPipeline::Handler::HandlerEntry handler : _loggedHandler->GetHandlers()) {
+            auto start = std::chrono::steady_clock::now();
+            try {
+                handler->Deliver(LoggerEventBatch(&data, 1));
+            } catch (std::exception &ex) {
+                std::cout << "Exception: " << ex.what() << "\n";
+            }
+            
+            if (auto metrics = FindHandlerMetrics(handler)) {
+                metrics->Record(1, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+        }
+        
+        for (auto &worker : _sinkWorkers) {
+            worker->Post(data);
         }
     }
 
-    void Logger::InternalOnLogged(std::shared_ptr<LoggerEventArgs> data) {
-        for (Logger::Handler::HandlerEntry handler : _loggedHandler->GetHandlers()) {
+    void LogPipeline::InternalOnLoggedBatch(LoggerEventBatch events) {
+        if (events.empty()) return;
+        
+        for (LogPipeline::Handler::HandlerEntry handler : _loggedHandler->GetHandlers()) {
+            auto start = std::chrono::steady_clock::now();
             try {
-                handler->Invoke(data);
+                handler->Deliver(events);
             } catch (std::exception &ex) {
                 std::cout << "Exception: " << ex.what() << "\n";
             }
+            
+            if (auto metrics = FindHandlerMetrics(handler)) {
+                metrics->Record(events.size(), std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+        }
+        
+        for (auto &worker : _sinkWorkers) {
+            for (auto &event : events) {
+                worker->Post(event);
+            }
         }
     }
 
-    void Logger::Log(LogLevel level,
+    void LogPipeline::FlushHandlers(std::function<void()> done) {
+        std::vector<std::future<void>> tasks;
+        
+        for (LogPipeline::Handler::HandlerEntry handler : _loggedHandler->GetHandlers()) {
+            try {
+                tasks.push_back(handler->Flush());
+            } catch (std::exception &ex) {
+                std::cout << "Exception: " << ex.what() << "\n";
+            }
+        }
+        
+        Future::WhenAll(tasks);
+        
+        if (_sinkWorkers.empty()) {
+            done();
+            return;
+        }
+        
+        // Complete once the last worker got there, without holding up the logger thread
+        auto remaining = std::make_shared<std::atomic<std::size_t>>(_sinkWorkers.size());
+        for (auto &worker : _sinkWorkers) {
+            worker->PostFlush([remaining, done]() {
+                if (remaining->fetch_sub(1, std::memory_order_acq_rel) == 1) done();
+            });
+        }
+    }
+
+    void LogPipeline::Log(LogLevel level,
                     std::shared_ptr<IComponent> text,
                     std::shared_ptr<TextColor> color,
                     std::shared_ptr<IComponent> name) {
-        auto threadId = std::this_thread::get_id();
-        auto tClone = text->Clone();
-        auto nameClone = name->Clone();
-        
-        auto args = std::make_shared<LoggerEventArgs>();
-        args->level = level;
-        args->tag = nameClone;
-        args->content = tClone;
-        args->color = color;
-        args->threadId = threadId;
-        args->timestamp = std::chrono::system_clock::now();
-        
-        CallOrQueue([args]() {
-            InternalOnLogged(args);
-        });
+        if (!IsEnabled(level)) return;
+        
+        auto args = _eventPool.Acquire(level, text->Clone(), color, name->Clone());
+        CallOrQueue({ std::move(args), nullptr });
     }
 
-    void Logger::Init() {
-        if (_isInitialized) {
-            throw std::runtime_error("Logger already initialized.");
-        }
-        
-        _isInitialized = true;
-        _loggedHandler = std::make_unique<AsyncEventHandler<IAsyncLogEventDelegate>>();
+    void LogPipeline::LogText(LogLevel level,
+                         std::string_view text,
+                         std::shared_ptr<TextColor> color,
+                         std::string_view name) {
+        auto args = _eventPool.Acquire(level, text, std::move(color), name);
+        CallOrQueue({ std::move(args), nullptr });
     }
 
-    void Logger::AddLoggedListener(std::shared_ptr<IAsyncLogEventDelegate> delegate) {
+    void LogPipeline::AddLoggedListener(std::shared_ptr<IAsyncLogEventDelegate> delegate, LogSinkDispatch dispatch) {
         if (!_loggedHandler) {
             throw std::runtime_error("_loggedHandler is not initialized");
         }
         
-        _loggedHandler->AddHandler(delegate);
+        UpdateListeners([this, delegate = std::move(delegate), dispatch]() {
+            if (dispatch == LogSinkDispatch::Dedicated) {
+                auto worker = std::make_shared<LogSinkWorker>(delegate);
+                std::lock_guard lock(_listenersMutex);
+                _sinkWorkers.push_back(std::move(worker));
+                return;
+            }
+            
+            _loggedHandler->AddHandler(delegate);
+            std::lock_guard lock(_listenersMutex);
+            _handlerMetrics.emplace_back(delegate, CreateRef<LogSinkMetrics>());
+        });
     }
 
-    void Logger::RemoveLoggedListener(std::shared_ptr<IAsyncLogEventDelegate> delegate) {
+    void LogPipeline::RemoveLoggedListener(std::shared_ptr<IAsyncLogEventDelegate> delegate) {
         if (!_loggedHandler) {
             throw std::runtime_error("_loggedHandler is not initialized");
         }
         
-        _loggedHandler->RemoveHandler(delegate);
+        UpdateListeners([this, delegate = std::move(delegate)]() {
+            _loggedHandler->RemoveHandler(delegate);
+            
+            Handle<LogSinkWorker> worker;
+            {
+                std::lock_guard lock(_listenersMutex);
+                std::erase_if(_handlerMetrics, [&](auto &entry) { return entry.first == delegate; });
+                
+                for (auto it = _sinkWorkers.begin(); it != _sinkWorkers.end(); ++it) {
+                    if ((*it)->GetHandler() == delegate) {
+                        worker = std::move(*it);
+                        _sinkWorkers.erase(it);
+                        break;
+                    }
+                }
+            }
+            
+            // Joining the worker can take a while, so nobody waits on the lock for it
+            if (worker) worker->Stop();
+        });
+    }
+
+    void LogPipeline::UpdateListeners(std::function<void()> update) {
+        // The logger thread walks the listeners without a lock, so once it may be running,
+        // changes are queued as a hook and applied between two batches
+        if (!_bootstrapped || std::this_thread::get_id() == _threadId.load(std::memory_order_relaxed)) {
+            update();
+            return;
+        }
+        
+        auto done = std::make_shared<std::promise<void>>();
+        auto future = done->get_future();
+        Enqueue({ nullptr, [update = std::move(update), done]() {
+            update();
+            done->set_value();
+        } });
+        
+        // A polling thread picks the change up whenever it polls next
+        if (_isRunning) future.wait();
+    }
+
+    void LogPipeline::SetCrashRing(Handle<LogCrashRing> ring) {
+        _crashRing = std::move(ring);
+    }
+
+    void LogPipeline::SetWaitStrategy(WaitStrategy strategy, UInt32 spinCount) {
+        if (_isRunning) {
+            throw std::runtime_error("Cannot change the wait strategy while the event loop is running.");
+        }
+        
+        _idleWaiter.SetStrategy(strategy, spinCount);
     }
 
-    void Logger::RunThreaded() {
+    void LogPipeline::RunThreaded() {
         if (_bootstrapped) return;
         _bootstrapped = true;
         
-        _thread = std::make_shared<std::thread>([&]() {
+        // Set before the thread starts, so that an early Join() is not overwritten
+        _isRunning = true;
+        _thread = std::thread([this]() {
             _threadId = std::this_thread::get_id();
             RunEventLoop();
         });
-        _thread->detach();
     }
 
-    void Logger::RunManualPoll() {
+    void LogPipeline::RunManualPoll() {
         if (_bootstrapped) return;
         _bootstrapped = true;
         _threadId = std::this_thread::get_id();
     }
 
-    void Logger::RunBlocking() {
+    void LogPipeline::RunBlocking() {
         if (_bootstrapped) return;
         _bootstrapped = true;
         _threadId = std::this_thread::get_id();
+        _isRunning = true;
         RunEventLoop();
     }
 
-    void Logger::Join() {
+    void LogPipeline::Join() {
         _isRunning = false;
+        _idleWaiter.Wake();
         
-        if (_thread.get()) {
-            _thread->join();
+        if (_thread.joinable()) {
+            _thread.join();
         }
     }
     
-    std::future<void> Logger::FlushAsync() {
+    std::future<void> LogPipeline::FlushAsync() {
         // Wrapping a promise in a shared_ptr and then move it.
         // It works?
         auto promise = std::make_shared<std::promise<void>>();
         std::future<void> future = promise->get_future();
         
-        if (std::this_thread::get_id() == _threadId) {
-            // Don't run this on logger thread
-            promise->set_value();
+        if (std::this_thread::get_id() == _threadId.load(std::memory_order_relaxed)) {
+            // Don't queue this on logger thread
+            FlushHandlers([promise]() { promise->set_value(); });
             return future;
         }
         
-        // Inject a hook to inform that previous events are handled
-        auto lock = std::lock_guard(_recordCallMutex);
-        _recordCall.push([promise = std::move(promise)]() {
-            // Complete the promise on executed
-            promise->set_value();
-        });
+        // Inject a hook to inform that previous events are handled.
+        // Cells are consumed in the order they were claimed, so every event enqueued
+        // before this point is dispatched before the promise completes.
+        Enqueue({ nullptr, [this, promise = std::move(promise)]() {
+            // Let buffering sinks write out, then complete the promise
+            FlushHandlers([promise]() { promise->set_value(); });
+        } });
 
         return future; 
     }
 
-    void Logger::PollEvents() {
+    void LogPipeline::FlushThen(LogFlushAwaitable* awaitable) {
+        // Both lambdas fit in the small buffer of std::function, so this does not allocate
+        if (std::this_thread::get_id() == _threadId.load(std::memory_order_relaxed)) {
+            FlushHandlers([awaitable]() { awaitable->Complete(); });
+            return;
+        }
+        
+        Enqueue({ nullptr, [this, awaitable]() {
+            FlushHandlers([awaitable]() { awaitable->Complete(); });
+        } });
+    }
+
+    // MARK: -
+
+    Bool LogFlushAwaitable::await_suspend(std::coroutine_handle<> handle) {
+        _handle = handle;
+        _pipeline->FlushThen(this);
+        
+        // Whichever of us and Complete() gets here second carries on with the coroutine.
+        // If the flush already finished, that is us, and we simply don't suspend.
+        return !_completed.exchange(true, std::memory_order_acq_rel);
+    }
+
+    void LogFlushAwaitable::Complete() {
+        if (_completed.exchange(true, std::memory_order_acq_rel)) {
+            _handle.resume();
+        }
+    }
+
+    void LogPipeline::PollEvents() {
         if (!_bootstrapped) {
             throw std::runtime_error("Logger is not bootstrapped");
         }
         
-        if (_threadId != std::this_thread::get_id()) {
+        if (_threadId.load(std::memory_order_relaxed) != std::this_thread::get_id()) {
             throw std::runtime_error("PollEvents() called from wrong thread");
         }
         
-        std::lock_guard<std::mutex> lock(_recordCallMutex);
-        while (!_recordCall.empty()) {
-            auto result = _recordCall.front();
+        // Detach a batch of records first so the cells are handed back to producers
+        // before any handler runs, then dispatch the batch without touching the queue.
+        RecordCall record;
+        std::size_t count;
+        do {
+            auto depth = _recordCall.GetSize();
+            if (depth > _queueHighWater.load(std::memory_order_relaxed)) {
+                _queueHighWater.store(depth, std::memory_order_relaxed);
+            }
+            
+            _pollBatch.clear();
+            while (_pollBatch.size() < MaxBatchSize && _recordCall.TryDequeue(record)) {
+                _pollBatch.push_back(std::move(record));
+            }
+            
+            count = _pollBatch.size();
+            DispatchBatch();
+        } while (count == MaxBatchSize);
+        
+        ReportDroppedEvents();
+    }
+
+    void LogPipeline::DispatchBatch() {
+        // Consecutive events are handed to the handlers together. Hooks split the batch so
+        // that they still run after every event queued before them has been dispatched.
+        _eventBatch.clear();
+        
+        for (auto &record : _pollBatch) {
+            if (record.event) {
+                _eventPool.FormatPending(record.event);
+                _eventBatch.push_back(std::move(record.event));
+                continue;
+            }
+            
+            ReleaseEventBatch();
             
             try {
-                result();
+                record.action();
             } catch (std::exception&) {
                 // Ignored.
             }
+        }
+        
+        ReleaseEventBatch();
+        _pollBatch.clear();
+    }
+
+    void LogPipeline::ReleaseEventBatch() {
+        RecordDispatch(_eventBatch);
+        InternalOnLoggedBatch(_eventBatch);
+        
+        for (auto &event : _eventBatch) {
+            ReleaseEvent(event);
+        }
+        
+        _eventBatch.clear();
+        RecycleInFlight();
+    }
+
+    void LogPipeline::RecordDispatch(LoggerEventBatch events) {
+        if (events.empty()) return;
+        
+        // One clock read covers the whole batch
+        auto now = LogClock::Now();
+        for (auto &event : events) {
+            auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(now - event->timestamp).count();
+            _latency.Record(latency > 0 ? (UInt64) latency : 0);
+        }
+        
+        _dispatched.store(_dispatched.load(std::memory_order_relaxed) + events.size(), std::memory_order_relaxed);
+    }
+
+    LogSinkMetrics* LogPipeline::FindHandlerMetrics(const Handle<IAsyncLogEventDelegate>& handler) {
+        for (auto &entry : _handlerMetrics) {
+            if (entry.first == handler) return entry.second.get();
+        }
+        
+        return nullptr;
+    }
+
+    LoggerMetrics LogPipeline::GetMetrics() const {
+        LoggerMetrics metrics {};
+        metrics.queueCapacity = _recordCall.GetCapacity();
+        metrics.queueDepth = _recordCall.GetSize();
+        metrics.queueHighWater = std::max(_queueHighWater.load(std::memory_order_relaxed), metrics.queueDepth);
+        metrics.enqueued = _recordCall.GetEnqueuedCount();
+        metrics.dispatched = _dispatched.load(std::memory_order_relaxed);
+        metrics.dropped = GetDroppedCount();
+        
+        metrics.latencySamples = _latency.GetCount();
+        metrics.latencyMean = std::chrono::nanoseconds((Int64) _latency.GetMean());
+        metrics.latencyP50 = std::chrono::nanoseconds(_latency.GetValueAtPercentile(50));
+        metrics.latencyP90 = std::chrono::nanoseconds(_latency.GetValueAtPercentile(90));
+        metrics.latencyP99 = std::chrono::nanoseconds(_latency.GetValueAtPercentile(99));
+        metrics.latencyP999 = std::chrono::nanoseconds(_latency.GetValueAtPercentile(99.9));
+        metrics.latencyMax = std::chrono::nanoseconds(_latency.GetMax());
+        
+        auto snapshot = [](const Handle<IAsyncLogEventDelegate>& handler, LogSinkDispatch dispatch,
+                           const LogSinkMetrics& sink, std::size_t queueDepth) {
+            return LogSinkMetricsSnapshot {
+                handler, dispatch, sink.GetBatches(), sink.GetEvents(),
+                std::chrono::nanoseconds(sink.GetTotalNanos()),
+                std::chrono::nanoseconds(sink.GetMaxNanos()),
+                queueDepth
+            };
+        };
+        
+        std::lock_guard lock(_listenersMutex);
+        for (auto &entry : _handlerMetrics) {
+            metrics.sinks.push_back(snapshot(entry.first, LogSinkDispatch::LoggerThread, *entry.second, 0));
+        }
+        
+        for (auto &worker : _sinkWorkers) {
+            metrics.sinks.push_back(snapshot(worker->GetHandler(), LogSinkDispatch::Dedicated,
+                                             *worker->GetMetrics(), worker->GetQueueDepth()));
+        }
+        
+        return metrics;
+    }
+
+    const LatencyHistogram& LogPipeline::GetLatencyHistogram() const {
+        return _latency;
+    }
+
+    void LogPipeline::ReleaseEvent(Handle<LoggerEventArgs>& event) {
+        if (event.use_count() == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            _eventPool.Release(event);
+        } else if (!_sinkWorkers.empty()) {
+            // Still queued for a dedicated sink
+            _inFlight.push_back(std::move(event));
+        }
+        
+        event = nullptr;
+    }
+
+    void LogPipeline::RecycleInFlight() {
+        for (std::size_t i = 0; i < _inFlight.size();) {
+            if (_inFlight[i].use_count() != 1) {
+                i++;
+                continue;
+            }
             
-            _recordCall.pop();
-            std::this_thread::yield();
+            // Pairs with the workers dropping their references
+            std::atomic_thread_fence(std::memory_order_acquire);
+            _eventPool.Release(_inFlight[i]);
+            _inFlight[i] = std::move(_inFlight.back());
+            _inFlight.pop_back();
+        }
+    }
+
+    void LogPipeline::LogSite(LogCallSite& site, std::string_view text) {
+        site.Bind(std::string_view());
+        
+        auto args = _eventPool.Acquire(site.level, text, GetLogLevelColor(site.level), site.tag);
+        args->site = &site;
+        CallOrQueue({ std::move(args), nullptr });
+    }
+
+    void LogPipeline::LogSuppressed(const LogCallSite& site, UInt64 count, std::string_view tag) {
+        LogFormatted(site.level, tag, "Suppressed {} repeats of the message logged at {}:{}.",
+                     count, site.location.file_name(), site.location.line());
+    }
+
+    void LogPipeline::SetMinimumLevel(LogLevel level) {
+        _minimumLevel.store(level, std::memory_order_relaxed);
+        
+        // Push the new value into every NamedLogger of this pipeline that follows its
+        // threshold, so their own checks stay a single load.
+        std::lock_guard<std::mutex> lock(GetNamedLoggerRegistryMutex());
+        for (auto logger : GetNamedLoggerRegistry()) {
+            if (logger->_pipeline == this && !logger->_hasOwnLevel) {
+                logger->_minimumLevel.store(level, std::memory_order_relaxed);
+            }
         }
     }
 
-    void Logger::Info(std::string str, std::string name) {
-        Log(LogLevel::Info, Component::Literal(str), TextColor::Green, Component::Literal(name));
+    LogLevel LogPipeline::GetMinimumLevel() const {
+        return _minimumLevel.load(std::memory_order_relaxed);
+    }
+
+    void LogPipeline::Verbose(std::string_view str, std::string_view name) {
+        if (!IsEnabled(LogLevel::Verbose)) return;
+        LogText(LogLevel::Verbose, str, TextColor::DarkGray, name);
+    }
+
+    void LogPipeline::Log(std::string_view str, std::string_view name) {
+        if (!IsEnabled(LogLevel::Log)) return;
+        LogText(LogLevel::Log, str, TextColor::Gray, name);
     }
 
-    void Logger::Warn(std::string str, std::string name) {
-        Log(LogLevel::Warn, Component::Literal(str), TextColor::Gold, Component::Literal(name));
+    void LogPipeline::Info(std::string_view str, std::string_view name) {
+        if (!IsEnabled(LogLevel::Info)) return;
+        LogText(LogLevel::Info, str, TextColor::Green, name);
     }
 
-    void Logger::Error(std::string str, std::string name) {
-        Log(LogLevel::Error, Component::Literal(str), TextColor::Red, Component::Literal(name));
+    void LogPipeline::Warn(std::string_view str, std::string_view name) {
+        if (!IsEnabled(LogLevel::Warn)) return;
+        LogText(LogLevel::Warn, str, TextColor::Gold, name);
+    }
+
+    void LogPipeline::Error(std::string_view str, std::string_view name) {
+        if (!IsEnabled(LogLevel::Error)) return;
+        LogText(LogLevel::Error, str, TextColor::Red, name);
+    }
+
+    void LogPipeline::Fatal(std::string_view str, std::string_view name) {
+        if (!IsEnabled(LogLevel::Fatal)) return;
+        LogText(LogLevel::Fatal, str, TextColor::DarkRed, name);
+    }
+
+    void LogPipeline::LogStructured(LogLevel level,
+                                    std::string_view text,
+                                    std::initializer_list<LogField> fields,
+                                    std::string_view name) {
+        if (!IsEnabled(level)) return;
+        
+        auto args = _eventPool.Acquire(level, text, GetLogLevelColor(level), name);
+        args->fields.Add(fields);
+        CallOrQueue({ std::move(args), nullptr });
     }
 
     // MARK: -
 
-    NamedLogger::NamedLogger(std::string name) : _name(name) {}
+    NamedLogger::NamedLogger(std::string name)
+    : NamedLogger(std::move(name), LogPipeline::GetDefault()) {}
+
+    NamedLogger::NamedLogger(std::string name, LogPipeline& pipeline)
+    : _name(std::move(name)), _tag(LogTags::Intern(_name)), _pipeline(&pipeline), _minimumLevel(pipeline.GetMinimumLevel()), _hasOwnLevel(false) {
+        Register();
+    }
+
+    NamedLogger::NamedLogger(const NamedLogger& other)
+    : _name(other._name), _tag(other._tag), _pipeline(other._pipeline), _minimumLevel(other._minimumLevel.load()), _hasOwnLevel(other._hasOwnLevel) {
+        Register();
+    }
+
+    NamedLogger& NamedLogger::operator=(const NamedLogger& other) {
+        std::lock_guard<std::mutex> lock(GetNamedLoggerRegistryMutex());
+        _name = other._name;
+        _tag = other._tag;
+        _pipeline = other._pipeline;
+        _hasOwnLevel = other._hasOwnLevel;
+        _minimumLevel.store(other._minimumLevel.load());
+        return *this;
+    }
+
+    NamedLogger::~NamedLogger() {
+        Unregister();
+    }
+
+    void NamedLogger::Register() {
+        std::lock_guard<std::mutex> lock(GetNamedLoggerRegistryMutex());
+        GetNamedLoggerRegistry().insert(this);
+    }
+
+    void NamedLogger::Unregister() {
+        std::lock_guard<std::mutex> lock(GetNamedLoggerRegistryMutex());
+        GetNamedLoggerRegistry().erase(this);
+    }
+
+    void NamedLogger::SetMinimumLevel(LogLevel level) {
+        std::lock_guard<std::mutex> lock(GetNamedLoggerRegistryMutex());
+        _hasOwnLevel = true;
+        _minimumLevel.store(level, std::memory_order_relaxed);
+    }
+
+    void NamedLogger::ResetMinimumLevel() {
+        std::lock_guard<std::mutex> lock(GetNamedLoggerRegistryMutex());
+        _hasOwnLevel = false;
+        _minimumLevel.store(_pipeline->GetMinimumLevel(), std::memory_order_relaxed);
+    }
+
+    void NamedLogger::LogText(LogLevel level, std::string_view str) {
+        if (!IsEnabled(level)) return;
+        auto args = _pipeline->_eventPool.Acquire(level, str, GetLogLevelColor(level), _tag);
+        _pipeline->CallOrQueue({ std::move(args), nullptr });
+    }
+
+    void NamedLogger::LogSite(LogCallSite& site, std::string_view text) {
+        site.Bind(std::string_view());
+        
+        auto args = _pipeline->_eventPool.Acquire(site.level, text, GetLogLevelColor(site.level), _tag);
+        args->site = &site;
+        _pipeline->CallOrQueue({ std::move(args), nullptr });
+    }
+
+    void NamedLogger::LogStructured(LogLevel level, std::string_view text, std::initializer_list<LogField> fields) {
+        if (!IsEnabled(level)) return;
+        
+        auto args = _pipeline->_eventPool.Acquire(level, text, GetLogLevelColor(level), _tag);
+        args->fields.Add(fields);
+        _pipeline->CallOrQueue({ std::move(args), nullptr });
+    }
+
+    void NamedLogger::Verbose(std::string_view str) {
+        LogText(LogLevel::Verbose, str);
+    }
+
+    void NamedLogger::Log(std::string_view str) {
+        LogText(LogLevel::Log, str);
+    }
+
+    void NamedLogger::Info(std::string_view str) {
+        LogText(LogLevel::Info, str);
+    }
 
-    void NamedLogger::Info(std::string str) {
-        Logger::Info(str, _name);
+    void NamedLogger::Warn(std::string_view str) {
+        LogText(LogLevel::Warn, str);
     }
 
-    void NamedLogger::Warn(std::string str) {
-        Logger::Warn(str, _name);
+    void NamedLogger::Error(std::string_view str) {
+        LogText(LogLevel::Error, str);
     }
 
-    void NamedLogger::Error(std::string str) {
-        Logger::Error(str, _name);
+    void NamedLogger::Fatal(std::string_view str) {
+        LogText(LogLevel::Fatal, str);
     }
 
 }
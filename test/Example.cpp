@@ -2,7 +2,7 @@
 // Created by 咔咔 on 2023/12/22.
 //
 
-#include <Mochi/Logging.h>
+#include <Mochi/LogTask.h>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -13,25 +13,17 @@
 template <typename T>
 using MHandle          = ::MOCHI_NAMESPACE::Handle<T>;
 using MLoggerEventArgs = ::MOCHI_NAMESPACE::LoggerEventArgs;
+using MLogTask         = ::MOCHI_NAMESPACE::LogTask;
 
-std::future<void> OnLogged(MHandle<MLoggerEventArgs> ev) {
-    auto timeT = std::chrono::system_clock::to_time_t(ev->timestamp);
-    auto time = localtime(&timeT);
+MLogTask OnLogged(MHandle<MLoggerEventArgs> ev) {
+    // Only called from the logger thread, so one formatter can be shared
+    static ::MOCHI_NAMESPACE::TimestampFormatter timestamps(::MOCHI_NAMESPACE::TimestampPrecision::Seconds);
 
-    std::stringstream sb;
-
-    sb << (time->tm_year + 1900) << "-";
-    sb << std::setfill('0') << std::setw(2);
-    sb << time->tm_mon << "-";
-    sb << std::setfill('0') << std::setw(2);
-    sb << time->tm_mday << " ";
+    std::string time;
+    timestamps.Append(time, ev->timestamp);
 
-    sb << std::setfill('0') << std::setw(2);
-    sb << time->tm_hour << ":";
-    sb << std::setfill('0') << std::setw(2);
-    sb << time->tm_min << ":";
-    sb << std::setfill('0') << std::setw(2);
-    sb << time->tm_sec << " ";
+    std::stringstream sb;
+    sb << time << " ";
 
     sb << "[Thread@" << ev->threadId << "] ";
 
@@ -67,19 +59,16 @@ std::future<void> OnLogged(MHandle<MLoggerEventArgs> ev) {
 
     sb << "\n";
     std::cout << sb.str();
-
-    std::promise<void> promise;
-    promise.set_value();
-    return promise.get_future();
+    co_return;
 }
 
 
 int main(int argc, char** argv) {
     using MLogger                 = ::MOCHI_NAMESPACE::Logger;
-    using MIAsyncLogEventDelegate = ::MOCHI_NAMESPACE::IAsyncLogEventDelegate;
+    using MLogTaskDelegate        = ::MOCHI_NAMESPACE::LogTaskDelegate;
 
     MLogger::Init();
-    MLogger::AddLoggedListener(MIAsyncLogEventDelegate::Create(OnLogged));
+    MLogger::AddLoggedListener(MLogTaskDelegate::Create(OnLogged));
     MLogger::RunThreaded();
 
     MLogger::Info("Hello, world.");
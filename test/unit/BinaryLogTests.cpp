@@ -0,0 +1,125 @@
+//
+//  BinaryLogTests.cpp
+//  Mochi
+//
+
+#include "Test.h"
+#include <Mochi/LogSinks.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace MOCHI_NAMESPACE;
+
+static std::filesystem::path GetTempPath(const char* name) {
+    return std::filesystem::temp_directory_path() / name;
+}
+
+static std::string GetThreadName(std::thread::id id) {
+    std::stringstream str;
+    str << id;
+    return str.str();
+}
+
+static Int64 ToMicroseconds(std::chrono::time_point<std::chrono::system_clock> time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+MOCHI_TEST(BinaryLog, RoundTripsEventsAndFields) {
+    auto path = GetTempPath("mochi-unittest-binary.mlog");
+    LoggerEventPool pool(8);
+
+    auto first = pool.Acquire(LogLevel::Info, "Started", nullptr, "Main");
+    auto second = pool.Acquire(LogLevel::Error, "Failed: \xe2\x9c\x97", nullptr, "Network");
+    second->fields.Add("attempt", 3);
+    second->fields.Add("offset", (UInt64) 1 << 40);
+    second->fields.Add("ratio", 0.25);
+    second->fields.Add("retry", true);
+    second->fields.Add("host", std::string_view("example.com"));
+
+    // Earlier than the first event, so the timestamp delta is negative
+    second->timestamp = first->timestamp - std::chrono::seconds(5);
+    auto third = pool.Acquire(LogLevel::Warn, "", nullptr, "Main");
+
+    {
+        BinaryLogSink sink(path.string());
+        sink.Invoke(first);
+        std::vector<Handle<LoggerEventArgs>> rest { second, third };
+        sink.InvokeBatch(LoggerEventBatch(rest.data(), rest.size()));
+    }
+
+    std::ifstream stream(path, std::ios::binary);
+    BinaryLogDecoder decoder(stream);
+    DecodedLogRecord record;
+
+    auto thread = GetThreadName(std::this_thread::get_id());
+
+    MOCHI_CHECK(decoder.Next(record));
+    MOCHI_CHECK(record.level == LogLevel::Info);
+    MOCHI_CHECK_EQ(record.tag, std::string("Main"));
+    MOCHI_CHECK_EQ(record.text, std::string("Started"));
+    MOCHI_CHECK_EQ(record.thread, thread);
+    MOCHI_CHECK_EQ(ToMicroseconds(record.timestamp), ToMicroseconds(first->timestamp));
+    MOCHI_CHECK(record.fields.IsEmpty());
+
+    MOCHI_CHECK(decoder.Next(record));
+    MOCHI_CHECK(record.level == LogLevel::Error);
+    MOCHI_CHECK_EQ(record.tag, std::string("Network"));
+    MOCHI_CHECK_EQ(record.text, std::string("Failed: \xe2\x9c\x97"));
+    MOCHI_CHECK_EQ(ToMicroseconds(record.timestamp), ToMicroseconds(second->timestamp));
+    MOCHI_CHECK_EQ(record.fields.GetCount(), std::size_t(5));
+
+    auto field = record.fields.begin();
+    MOCHI_CHECK_EQ((*field).GetKey(), std::string_view("attempt"));
+    MOCHI_CHECK((*field).GetType() == LogFieldType::Int64);
+    MOCHI_CHECK_EQ((*field).GetInt64(), Int64(3));
+    ++field;
+    MOCHI_CHECK((*field).GetType() == LogFieldType::UInt64);
+    MOCHI_CHECK_EQ((*field).GetUInt64(), (UInt64) 1 << 40);
+    ++field;
+    MOCHI_CHECK((*field).GetType() == LogFieldType::Double);
+    MOCHI_CHECK_EQ((*field).GetDouble(), 0.25);
+    ++field;
+    MOCHI_CHECK((*field).GetType() == LogFieldType::Bool);
+    MOCHI_CHECK((*field).GetBool());
+    ++field;
+    MOCHI_CHECK((*field).GetType() == LogFieldType::String);
+    MOCHI_CHECK_EQ((*field).GetString(), std::string_view("example.com"));
+
+    MOCHI_CHECK(decoder.Next(record));
+    MOCHI_CHECK(record.level == LogLevel::Warn);
+    MOCHI_CHECK_EQ(record.tag, std::string("Main"));
+    MOCHI_CHECK_EQ(record.text, std::string());
+    MOCHI_CHECK(record.fields.IsEmpty());
+
+    MOCHI_CHECK(!decoder.Next(record));
+    stream.close();
+    std::filesystem::remove(path);
+}
+
+MOCHI_TEST(BinaryLog, RejectsForeignFiles) {
+    std::stringstream stream("NOTALOG\x01");
+    MOCHI_CHECK_THROWS(BinaryLogDecoder(stream));
+}
+
+MOCHI_TEST(BinaryLog, ThrowsOnTruncatedRecords) {
+    auto path = GetTempPath("mochi-unittest-truncated.mlog");
+    LoggerEventPool pool(1);
+
+    {
+        BinaryLogSink sink(path.string());
+        sink.Invoke(pool.Acquire(LogLevel::Info, "A message long enough to cut in half", nullptr, "Main"));
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::filesystem::remove(path);
+
+    std::stringstream stream(bytes.substr(0, bytes.size() - 8));
+    BinaryLogDecoder decoder(stream);
+    DecodedLogRecord record;
+    MOCHI_CHECK_THROWS(decoder.Next(record));
+}
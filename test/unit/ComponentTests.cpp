@@ -0,0 +1,289 @@
+//
+//  ComponentTests.cpp
+//  Mochi
+//
+
+#include "Test.h"
+#include <Mochi/Components.h>
+#include <json/json.h>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace MOCHI_NAMESPACE;
+
+static std::string GetText(const IComponent::Ref& component) {
+    std::string text;
+    Component::AppendPlainText(component, text);
+    return text;
+}
+
+MOCHI_TEST(ComponentArena, AppendsToArenaNodesOnOtherThreads) {
+    ComponentBuilder builder;
+    auto first = builder.Literal("a");
+    auto second = builder.Literal("b");
+
+    // Both sibling lists are allocated off the owner's thread, at the same time
+    std::thread one([&first]() { for (int i = 0; i < 100; i++) first->Append(Component::Literal("x")); });
+    std::thread two([&second]() { for (int i = 0; i < 100; i++) second->Append(Component::Literal("y")); });
+    one.join();
+    two.join();
+
+    MOCHI_CHECK_EQ(GetText(first), "a" + std::string(100, 'x'));
+    MOCHI_CHECK_EQ(GetText(second), "b" + std::string(100, 'y'));
+}
+
+MOCHI_TEST(ComponentArena, AppendsToArenaNodesAfterRelease) {
+    IMutableComponent::Ref message;
+    {
+        ComponentBuilder builder;
+        message = builder.Literal("Player ");
+    }
+
+    message->Append(Component::Literal("joined"));
+    MOCHI_CHECK_EQ(GetText(message), std::string("Player joined"));
+
+    // The list allocated after the release goes back to the heap, the node to the arena
+    message = nullptr;
+}
+
+MOCHI_TEST(ComponentArena, OutlivesListsSharedAfterRelease) {
+    IMutableComponent::Ref node;
+    {
+        ComponentBuilder builder;
+        node = builder.Create(CreateRef<LiteralContent>("x"), BasicColoredStyle::Empty());
+    }
+
+    // The list is allocated through the released arena, and the clone keeps it after the node
+    node->Append(Component::Literal("y"));
+    auto clone = node->Clone();
+    node.reset();
+    MOCHI_CHECK_EQ(GetText(clone), std::string("xy"));
+    clone.reset();
+}
+
+MOCHI_TEST(ComponentArena, FreesTreesOnOtherThreads) {
+    ComponentBuilder builder;
+    auto message = builder.Literal("Player ");
+    message->Append(builder.Literal("Steve", TextColor::Gold));
+    builder.Reset();
+
+    std::thread([message = std::move(message)]() mutable {
+        MOCHI_CHECK_EQ(GetText(message), std::string("Player Steve"));
+        message = nullptr;
+    }).join();
+}
+
+MOCHI_TEST(BasicColoredStyle, RecoloredLeavesTheStyleUntouched) {
+    auto gold = BasicColoredStyle::Of(TextColor::Gold);
+    auto red = gold->Recolored(TextColor::Red);
+
+    MOCHI_CHECK(gold->GetColor() == TextColor::Gold);
+    MOCHI_CHECK(red->GetColor() == TextColor::Red);
+    MOCHI_CHECK(red == BasicColoredStyle::Of(TextColor::Red));
+}
+
+static IMutableComponent::Ref AsMutable(const IComponent::Ref& component) {
+    return std::dynamic_pointer_cast<IMutableComponent>(component);
+}
+
+MOCHI_TEST(Component, AppendKeepsTheSiblingItWasGiven) {
+    auto message = AsMutable(Component::Literal("Player "));
+    auto name = AsMutable(Component::Literal("Steve"));
+    message->Append(name);
+
+    name->Append(Component::Literal("!"));
+    MOCHI_CHECK_EQ(GetText(message), std::string("Player Steve!"));
+    MOCHI_CHECK(message->GetSiblings().front() == name);
+}
+
+MOCHI_TEST(Component, ClonesKeepTheirSiblingsApart) {
+    auto message = AsMutable(Component::Literal("a"));
+    message->Append(Component::Literal("b"));
+
+    auto clone = message->Clone();
+    message->Append(Component::Literal("c"));
+    clone->Append(Component::Literal("d"));
+
+    MOCHI_CHECK_EQ(GetText(message), std::string("abc"));
+    MOCHI_CHECK_EQ(GetText(clone), std::string("abd"));
+}
+
+MOCHI_TEST(Component, ClonesIgnoreChangesToHeldSiblings) {
+    auto message = AsMutable(Component::Literal("Player "));
+    auto name = AsMutable(Component::Literal("Steve"));
+    message->Append(name);
+
+    auto clone = message->Clone();
+    name->SetStyle(BasicColoredStyle::Of(TextColor::Red));
+    name->Append(Component::Literal("!"));
+
+    MOCHI_CHECK_EQ(GetText(message), std::string("Player Steve!"));
+    MOCHI_CHECK_EQ(GetText(clone), std::string("Player Steve"));
+    MOCHI_CHECK(clone->GetSiblings().front()->GetStyle() == BasicColoredStyle::Empty());
+}
+
+MOCHI_TEST(Component, ChangesThroughSiblingsStayInTheirTree) {
+    auto message = AsMutable(Component::Literal("a"));
+    auto inner = AsMutable(Component::Literal("b"));
+    inner->Append(Component::Literal("c"));
+    message->Append(std::move(inner));
+
+    auto clone = message->Clone();
+    AsMutable(clone->GetSiblings().front())->Append(Component::Literal("d"));
+    AsMutable(message->GetSiblings().front())->SetStyle(BasicColoredStyle::Of(TextColor::Gold));
+
+    // Edits made through the siblings handed out stick to their own tree only
+    MOCHI_CHECK_EQ(GetText(message), std::string("abc"));
+    MOCHI_CHECK_EQ(GetText(clone), std::string("abcd"));
+    MOCHI_CHECK(message->GetSiblings().front()->GetStyle() == BasicColoredStyle::Of(TextColor::Gold));
+    MOCHI_CHECK(clone->GetSiblings().front()->GetStyle() == BasicColoredStyle::Empty());
+
+    // A second clone sees the first tree's edits, not the other clone's
+    MOCHI_CHECK_EQ(GetText(message->Clone()), std::string("abc"));
+}
+
+MOCHI_TEST(Component, ClonesCanBeReadWhileTheTreeChanges) {
+    ComponentBuilder builder;
+    auto message = builder.Literal("a");
+    for (int i = 0; i < 16; i++) message->Append(builder.Literal("b"));
+
+    auto clone = message->Clone();
+    std::thread reader([clone]() {
+        for (int i = 0; i < 100; i++) {
+            MOCHI_CHECK_EQ(GetText(clone), "a" + std::string(16, 'b'));
+            clone->GetSiblings();
+        }
+    });
+
+    for (int i = 0; i < 100; i++) {
+        AsMutable(message->GetSiblings().back())->Append(builder.Literal("c"));
+        message->Clone();
+    }
+
+    reader.join();
+    MOCHI_CHECK_EQ(GetText(message), "a" + std::string(16, 'b') + std::string(100, 'c'));
+}
+
+// A second content type, whose key sorts before "text"
+class KeybindContentType : public IContentType {
+public:
+    IContent::Ref CreateContent(Json::Value payload) override {
+        return CreateRef<LiteralContent>("<" + payload["keybind"].asString() + ">");
+    }
+
+    void InsertPayload(Json::Value, IContent::Ref) override {}
+};
+
+static Json::Value ParseDocument(const std::string& json) {
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+
+    Json::Value value;
+    MOCHI_CHECK(reader->parse(json.data(), json.data() + json.size(), &value, nullptr));
+    return value;
+}
+
+MOCHI_TEST(Component, ParsesTheSameContentFromTextAndDocuments) {
+    TextContentTypes::Register("keybind", std::make_shared<KeybindContentType>());
+
+    const std::string cases[] = {
+        R"({"text": "a", "keybind": "b"})",
+        R"({"keybind": "b", "text": "a"})",
+        R"({"text": "a", "extra": [{"keybind": "b", "text": "c"}, "d"], "color": "gold"})",
+        R"(["a", {"text": "b", "keybind": "c", "color": "red"}])",
+        R"({"text": "a", "color": 5, "extra": [{"text": "b", "color": ["red"]}]})",
+        R"(["a", 1.5, 0.1, 12, -3, 1e2, 18446744073709551615, 18446744073709551616, -9223372036854775809, true])",
+    };
+
+    for (auto &json : cases) {
+        auto parsed = ComponentRuns::Compile(Component::ParseJson(json));
+        auto built = ComponentRuns::Compile(Component::FromJson(ParseDocument(json)));
+        MOCHI_CHECK_EQ(parsed.GetText(), built.GetText());
+        MOCHI_CHECK_EQ(parsed.GetCount(), built.GetCount());
+        for (std::size_t i = 0; i < parsed.GetCount() && i < built.GetCount(); i++) {
+            MOCHI_CHECK(parsed[i].style == built[i].style);
+        }
+    }
+
+    MOCHI_CHECK_EQ(GetText(Component::ParseJson(cases[0])), std::string("<b>"));
+    MOCHI_CHECK_EQ(GetText(Component::ParseJson(cases[1])), std::string("<b>"));
+}
+
+static IMutableComponent::Ref Colored(std::string text, const TextColor::Ref& color) {
+    auto component = AsMutable(Component::Literal(std::move(text)));
+    component->SetStyle(BasicColoredStyle::Of(color));
+    return component;
+}
+
+MOCHI_TEST(ComponentRuns, MergesNeighborsWithTheSameStyle) {
+    auto message = AsMutable(Component::Literal("Player "));
+    message->Append(Colored("St", TextColor::Gold));
+    message->Append(Colored("", TextColor::Red));
+    message->Append(Colored("eve", TextColor::Gold));
+    message->Append(Component::Literal(" joined"));
+
+    auto runs = ComponentRuns::Compile(message);
+    MOCHI_CHECK_EQ(runs.GetText(), std::string_view("Player Steve joined"));
+    MOCHI_CHECK_EQ(runs.GetCount(), std::size_t(3));
+
+    auto gold = BasicColoredStyle::Of(TextColor::Gold);
+    MOCHI_CHECK_EQ(runs[0].text, std::string_view("Player "));
+    MOCHI_CHECK(runs[0].style == BasicColoredStyle::Empty());
+    MOCHI_CHECK_EQ(runs[1].text, std::string_view("Steve"));
+    MOCHI_CHECK(runs[1].style == gold);
+    MOCHI_CHECK_EQ(runs[2].text, std::string_view(" joined"));
+    MOCHI_CHECK(runs[2].style == BasicColoredStyle::Empty());
+
+    // The runs point into the text back to back
+    MOCHI_CHECK(runs[1].text.data() == runs.GetText().data() + 7);
+    MOCHI_CHECK(runs[2].text.data() == runs[1].text.data() + runs[1].text.size());
+}
+
+MOCHI_TEST(ComponentRuns, ResolvesStylesAgainstTheirParents) {
+    auto message = Colored("a", TextColor::Gold);
+    auto inner = AsMutable(Component::Literal("b"));
+    inner->Append(Colored("c", TextColor::Red));
+    message->Append(inner);
+
+    auto runs = ComponentRuns::Compile(message);
+    MOCHI_CHECK_EQ(runs.GetCount(), std::size_t(2));
+    MOCHI_CHECK_EQ(runs[0].text, std::string_view("ab"));
+    MOCHI_CHECK(runs[0].style == BasicColoredStyle::Of(TextColor::Gold));
+    MOCHI_CHECK_EQ(runs[1].text, std::string_view("c"));
+    MOCHI_CHECK(runs[1].style == BasicColoredStyle::Of(TextColor::Red));
+
+    // Without a color of its own, the root takes the outer style
+    auto outer = ComponentRuns::Compile(Component::Literal("d"), BasicColoredStyle::Of(TextColor::Blue));
+    MOCHI_CHECK(outer[0].style == BasicColoredStyle::Of(TextColor::Blue));
+}
+
+MOCHI_TEST(ComponentRuns, IteratesInOrder) {
+    auto message = Colored("a", TextColor::Gold);
+    message->Append(Colored("b", TextColor::Red));
+    message->Append(Colored("c", TextColor::Gold));
+
+    auto runs = ComponentRuns::Compile(message);
+    std::string text;
+    std::size_t index = 0;
+    for (auto run : runs) {
+        MOCHI_CHECK(run.style == runs[index].style);
+        text += run.text;
+        text += '|';
+        index++;
+    }
+
+    MOCHI_CHECK_EQ(index, std::size_t(3));
+    MOCHI_CHECK_EQ(text, std::string("a|b|c|"));
+}
+
+MOCHI_TEST(ComponentRuns, KeepsASnapshotOfTheTree) {
+    auto message = AsMutable(Component::Literal("a"));
+    auto runs = ComponentRuns::Compile(message);
+    message->Append(Component::Literal("b"));
+    message->SetStyle(BasicColoredStyle::Of(TextColor::Red));
+
+    MOCHI_CHECK_EQ(runs.GetText(), std::string_view("a"));
+    MOCHI_CHECK(runs[0].style == BasicColoredStyle::Empty());
+    MOCHI_CHECK(ComponentRuns::Compile(Component::Literal("")).IsEmpty());
+}
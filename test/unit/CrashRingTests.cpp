@@ -0,0 +1,146 @@
+//
+//  CrashRingTests.cpp
+//  Mochi
+//
+
+#include "Test.h"
+#include <Mochi/LogCrashRing.h>
+#include <filesystem>
+#include <string>
+
+using namespace MOCHI_NAMESPACE;
+
+static std::string GetTempPath(const char* name) {
+    auto path = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove(path);
+    std::filesystem::remove(path.string() + ".prev");
+    return path.string();
+}
+
+static void RemoveRing(const std::string& path) {
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".prev");
+}
+
+MOCHI_TEST(CrashRing, RecoversPipelineEvents) {
+    auto path = GetTempPath("mochi-unittest.ring");
+
+    {
+        LogPipeline pipeline;
+        pipeline.RunManualPoll();
+        pipeline.SetCrashRing(CreateRef<LogCrashRing>(path, 16));
+
+        pipeline.Info("Plain", "Main");
+        pipeline.Warn("Answer: {}, {}", 42, "yes");
+        pipeline.LogStructured(LogLevel::Error, "Request failed",
+                               { { "status", 503 }, { "path", std::string_view("/index") }, { "retry", true } },
+                               "Http");
+    }
+
+    auto records = LogCrashRing::Recover(path);
+    MOCHI_CHECK_EQ(records.size(), std::size_t(3));
+
+    MOCHI_CHECK(records[0].level == LogLevel::Info);
+    MOCHI_CHECK_EQ(records[0].tag, std::string("Main"));
+    MOCHI_CHECK_EQ(records[0].text, std::string("Plain"));
+
+    MOCHI_CHECK(records[1].level == LogLevel::Warn);
+    MOCHI_CHECK_EQ(records[1].tag, std::string("Logger"));
+    MOCHI_CHECK_EQ(records[1].text, std::string("Answer: 42, yes"));
+
+    MOCHI_CHECK_EQ(records[2].tag, std::string("Http"));
+    MOCHI_CHECK_EQ(records[2].text, std::string("Request failed"));
+    MOCHI_CHECK_EQ(records[2].fields.GetCount(), std::size_t(3));
+
+    auto field = records[2].fields.begin();
+    MOCHI_CHECK_EQ((*field).GetKey(), std::string_view("status"));
+    MOCHI_CHECK_EQ((*field).GetInt64(), Int64(503));
+    ++field;
+    MOCHI_CHECK_EQ((*field).GetString(), std::string_view("/index"));
+    ++field;
+    MOCHI_CHECK((*field).GetType() == LogFieldType::Bool);
+    MOCHI_CHECK((*field).GetBool());
+
+    RemoveRing(path);
+}
+
+MOCHI_TEST(CrashRing, RecoversNamedLoggerTags) {
+    auto path = GetTempPath("mochi-unittest-named.ring");
+
+    {
+        LogPipeline pipeline;
+        pipeline.RunManualPoll();
+        pipeline.SetCrashRing(CreateRef<LogCrashRing>(path, 16));
+
+        NamedLogger logger("Network", pipeline);
+        MOCHI_NAMED_LOG_INFO(logger, "Connected");
+        MOCHI_NAMED_LOG_WARN(logger, "Retrying in {} ms", 250);
+        logger.Error("Gave up after {} attempts", 3);
+        logger.LogStructured(LogLevel::Info, "Closed", { { "bytes", (UInt64) 1024 } });
+    }
+
+    auto records = LogCrashRing::Recover(path);
+    MOCHI_CHECK_EQ(records.size(), std::size_t(4));
+
+    for (auto& record : records) {
+        MOCHI_CHECK_EQ(record.tag, std::string("Network"));
+    }
+
+    MOCHI_CHECK_EQ(records[0].text, std::string("Connected"));
+    MOCHI_CHECK_EQ(records[1].text, std::string("Retrying in 250 ms"));
+    MOCHI_CHECK_EQ(records[2].text, std::string("Gave up after 3 attempts"));
+    MOCHI_CHECK_EQ(records[3].fields.GetCount(), std::size_t(1));
+    MOCHI_CHECK_EQ((*records[3].fields.begin()).GetUInt64(), UInt64(1024));
+
+    RemoveRing(path);
+}
+
+MOCHI_TEST(CrashRing, KeepsOnlyWholeFieldsThatFit) {
+    auto path = GetTempPath("mochi-unittest-small.ring");
+
+    {
+        LogPipeline pipeline;
+        pipeline.RunManualPoll();
+
+        // The smallest slot leaves 96 bytes of payload
+        pipeline.SetCrashRing(CreateRef<LogCrashRing>(path, 4, 128));
+
+        std::string large(80, 'x');
+        pipeline.LogStructured(LogLevel::Info, "Fields",
+                               { { "a", 1 }, { "large", std::string_view(large) }, { "b", 2 } },
+                               "Main");
+    }
+
+    auto records = LogCrashRing::Recover(path);
+    MOCHI_CHECK_EQ(records.size(), std::size_t(1));
+    MOCHI_CHECK_EQ(records[0].text, std::string("Fields [truncated]"));
+    MOCHI_CHECK_EQ(records[0].fields.GetCount(), std::size_t(1));
+    MOCHI_CHECK_EQ((*records[0].fields.begin()).GetKey(), std::string_view("a"));
+
+    RemoveRing(path);
+}
+
+MOCHI_TEST(CrashRing, KeepsTheMostRecentRecords) {
+    auto path = GetTempPath("mochi-unittest-wrap.ring");
+
+    {
+        LogPipeline pipeline;
+        pipeline.RunManualPoll();
+        pipeline.SetCrashRing(CreateRef<LogCrashRing>(path, 8));
+
+        for (int i = 0; i < 20; i++) {
+            pipeline.Info("Event {}", i);
+        }
+    }
+
+    auto records = LogCrashRing::Recover(path);
+    MOCHI_CHECK_EQ(records.size(), std::size_t(8));
+    MOCHI_CHECK_EQ(records.front().text, std::string("Event 12"));
+    MOCHI_CHECK_EQ(records.back().text, std::string("Event 19"));
+
+    auto last = LogCrashRing::Recover(path, 3);
+    MOCHI_CHECK_EQ(last.size(), std::size_t(3));
+    MOCHI_CHECK_EQ(last.front().text, std::string("Event 17"));
+
+    RemoveRing(path);
+}
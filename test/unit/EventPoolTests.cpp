@@ -0,0 +1,94 @@
+//
+//  EventPoolTests.cpp
+//  Mochi
+//
+
+#include "Test.h"
+#include <Mochi/Logging.h>
+#include <memory>
+#include <string>
+
+using namespace MOCHI_NAMESPACE;
+
+static std::string GetText(const IComponent::Ref& component) {
+    std::string text;
+    Component::AppendPlainText(component, text);
+    return text;
+}
+
+MOCHI_TEST(EventPool, RecyclesReleasedEvents) {
+    LoggerEventPool pool(4);
+
+    auto event = pool.Acquire(LogLevel::Info, "first", nullptr, "Tag");
+    event->fields.Add("count", 3);
+    auto* address = event.get();
+    MOCHI_CHECK_EQ(GetText(event->content), std::string("first"));
+    MOCHI_CHECK_EQ(GetText(event->tag), std::string("Tag"));
+
+    pool.Release(event);
+    MOCHI_CHECK(event == nullptr);
+
+    auto again = pool.Acquire(LogLevel::Warn, "second", nullptr, "Other");
+    MOCHI_CHECK(again.get() == address);
+    MOCHI_CHECK(again->level == LogLevel::Warn);
+    MOCHI_CHECK_EQ(GetText(again->content), std::string("second"));
+    MOCHI_CHECK_EQ(GetText(again->tag), std::string("Other"));
+    MOCHI_CHECK(again->fields.IsEmpty());
+    MOCHI_CHECK(again->site == nullptr);
+}
+
+MOCHI_TEST(EventPool, KeepsEventsThatAreStillReferenced) {
+    LoggerEventPool pool(4);
+
+    auto event = pool.Acquire(LogLevel::Info, "held", nullptr, "Tag");
+    auto* address = event.get();
+    auto held = event;
+    pool.Release(event);
+
+    auto next = pool.Acquire(LogLevel::Info, "next", nullptr, "Tag");
+    MOCHI_CHECK(next.get() != address);
+    MOCHI_CHECK_EQ(GetText(held->content), std::string("held"));
+}
+
+MOCHI_TEST(EventPool, KeepsEventsWhoseContentIsStillReferenced) {
+    LoggerEventPool pool(4);
+
+    auto event = pool.Acquire(LogLevel::Info, "content", nullptr, "Tag");
+    std::weak_ptr<LoggerEventArgs> released = event;
+    auto content = event->content;
+    pool.Release(event);
+    MOCHI_CHECK(released.expired());
+
+    // Recycling would have overwritten the text the handler still sees
+    auto next = pool.Acquire(LogLevel::Info, "overwritten?", nullptr, "Tag");
+    MOCHI_CHECK_EQ(GetText(content), std::string("content"));
+}
+
+MOCHI_TEST(EventPool, DropsOversizedTextBuffers) {
+    LoggerEventPool pool(4);
+
+    std::string large(LoggerEventPool::MaxRetainedTextSize * 2, 'x');
+    auto event = pool.Acquire(LogLevel::Info, large, nullptr, "Tag");
+    auto literal = CastRef<LiteralContent>(event->content->GetContent());
+    literal = nullptr;
+    pool.Release(event);
+
+    auto next = pool.Acquire(LogLevel::Info, "", nullptr, "Tag");
+    auto text = CastRef<LiteralContent>(next->content->GetContent());
+    MOCHI_CHECK(text->text.capacity() <= LoggerEventPool::MaxRetainedTextSize);
+}
+
+MOCHI_TEST(EventPool, FreesEventsOnceFull) {
+    // Pools hold at least two events
+    LoggerEventPool pool(2);
+
+    auto first = pool.Acquire(LogLevel::Info, "a", nullptr, "Tag");
+    auto second = pool.Acquire(LogLevel::Info, "b", nullptr, "Tag");
+    auto third = pool.Acquire(LogLevel::Info, "c", nullptr, "Tag");
+    std::weak_ptr<LoggerEventArgs> weak = third;
+
+    pool.Release(first);
+    pool.Release(second);
+    pool.Release(third);
+    MOCHI_CHECK(weak.expired());
+}
@@ -0,0 +1,77 @@
+//
+//  FileLogSinkTests.cpp
+//  Mochi
+//
+
+#include "Test.h"
+#include <Mochi/LogSinks.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace MOCHI_NAMESPACE;
+
+static std::string ReadFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static void RemoveLogs(const std::string& path) {
+    std::filesystem::remove(path);
+    for (int i = 1; i <= 5; i++) {
+        std::filesystem::remove(path + "." + std::to_string(i));
+    }
+}
+
+MOCHI_TEST(FileLogSink, FlushesIdleBuffersOnSchedule) {
+    auto path = (std::filesystem::temp_directory_path() / "mochi-unittest-idle.log").string();
+    RemoveLogs(path);
+
+    FileLogSinkOptions options { path };
+    options.flushInterval = std::chrono::milliseconds(20);
+
+    LoggerEventPool pool(2);
+    FileLogSink sink(options);
+    sink.Invoke(pool.Acquire(LogLevel::Info, "Only event", nullptr, "Main"));
+
+    // Nothing else is logged, so only the writer's own timer can write the line
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (ReadFile(path).find("Only event") == std::string::npos && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    MOCHI_CHECK(ReadFile(path).find("[Info] [Main] Only event\n") != std::string::npos);
+    RemoveLogs(path);
+}
+
+MOCHI_TEST(FileLogSink, RotatesBySize) {
+    auto path = (std::filesystem::temp_directory_path() / "mochi-unittest-rotate.log").string();
+    RemoveLogs(path);
+
+    {
+        FileLogSinkOptions options { path };
+        options.format = FileLogFormat::JsonLines;
+        options.maxFileSize = 256;
+        options.maxFiles = 2;
+
+        LoggerEventPool pool(2);
+        FileLogSink sink(options);
+        for (int i = 0; i < 20; i++) {
+            sink.Invoke(pool.Acquire(LogLevel::Info, "Event " + std::to_string(i), nullptr, "Main"));
+        }
+
+        sink.Flush().get();
+        MOCHI_CHECK(ReadFile(path).find("\"Event 19\"") != std::string::npos);
+    }
+
+    MOCHI_CHECK(std::filesystem::exists(path + ".1"));
+    MOCHI_CHECK(std::filesystem::exists(path + ".2"));
+    MOCHI_CHECK(!std::filesystem::exists(path + ".3"));
+
+    for (auto& file : { path, path + ".1", path + ".2" }) {
+        MOCHI_CHECK(std::filesystem::file_size(file) <= 256);
+    }
+
+    RemoveLogs(path);
+}
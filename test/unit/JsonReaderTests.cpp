@@ -0,0 +1,141 @@
+//
+//  JsonReaderTests.cpp
+//  Mochi
+//
+
+#include "Test.h"
+#include <Mochi/JsonReader.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+using namespace MOCHI_NAMESPACE;
+
+static std::string ReadString(const std::string& json) {
+    JsonReader reader(json);
+    auto result = reader.ReadString();
+    reader.ExpectEnd();
+    return result;
+}
+
+static void ReadDocument(const std::string& json) {
+    JsonReader reader(json);
+    reader.ReadValue();
+    reader.ExpectEnd();
+}
+
+MOCHI_TEST(JsonReader, WalksObjectsAndArrays) {
+    JsonReader reader(R"( {"name": "Steve", "tags": [1, true, null, {"deep": []}], "level": -2.5e1} )");
+    std::string name;
+    double level = 0;
+    int tags = 0;
+
+    reader.BeginObject();
+    std::string_view key;
+    while (reader.NextKey(key)) {
+        if (key == "name") {
+            name = reader.ReadString();
+        } else if (key == "level") {
+            level = reader.ReadNumber();
+        } else {
+            reader.BeginArray();
+            while (reader.NextElement()) {
+                tags++;
+                reader.Skip();
+            }
+        }
+    }
+
+    reader.ExpectEnd();
+    MOCHI_CHECK_EQ(name, std::string("Steve"));
+    MOCHI_CHECK_EQ(level, -25.0);
+    MOCHI_CHECK_EQ(tags, 4);
+}
+
+MOCHI_TEST(JsonReader, HandsOutStringsWithoutEscapesAsViews) {
+    std::string json = R"("plain")";
+    JsonReader reader(json);
+    auto view = reader.ReadStringView();
+    MOCHI_CHECK(view.data() == json.data() + 1);
+    MOCHI_CHECK_EQ(view, std::string_view("plain"));
+}
+
+MOCHI_TEST(JsonReader, UnescapesStrings) {
+    MOCHI_CHECK_EQ(ReadString(R"("a\"b\\c\/d\b\f\n\r\t")"), std::string("a\"b\\c/d\b\f\n\r\t"));
+    MOCHI_CHECK_EQ(ReadString(R"("\u0041\u00e9\u20AC")"), std::string("A\xc3\xa9\xe2\x82\xac"));
+}
+
+MOCHI_TEST(JsonReader, CombinesSurrogatePairs) {
+    MOCHI_CHECK_EQ(ReadString(R"("\ud83d\ude00")"), std::string("\xf0\x9f\x98\x80"));
+
+    // Halves that do not pair up are replaced one by one
+    MOCHI_CHECK_EQ(ReadString(R"("\ud83d")"), std::string("\xef\xbf\xbd"));
+    MOCHI_CHECK_EQ(ReadString(R"("\ude00x")"), std::string("\xef\xbf\xbdx"));
+    MOCHI_CHECK_EQ(ReadString(R"("\ud83dA")"), std::string("\xef\xbf\xbd" "A"));
+    MOCHI_CHECK_EQ(ReadString(R"("\ud83d\ud83d")"), std::string("\xef\xbf\xbd\xef\xbf\xbd"));
+}
+
+MOCHI_TEST(JsonReader, RejectsMalformedStrings) {
+    MOCHI_CHECK_THROWS(ReadString(R"("open)"));
+    MOCHI_CHECK_THROWS(ReadString(R"("bad \x escape")"));
+    MOCHI_CHECK_THROWS(ReadString(R"("\u12")"));
+    MOCHI_CHECK_THROWS(ReadString(R"("\uzzzz")"));
+    MOCHI_CHECK_THROWS(ReadString("\"tab\tinside\""));
+    MOCHI_CHECK_THROWS(ReadString(R"("trailing\)"));
+}
+
+MOCHI_TEST(JsonReader, RejectsMalformedDocuments) {
+    MOCHI_CHECK_THROWS(ReadDocument(""));
+    MOCHI_CHECK_THROWS(ReadDocument("[1, 2"));
+    MOCHI_CHECK_THROWS(ReadDocument("[1, ]"));
+    MOCHI_CHECK_THROWS(ReadDocument("[1 2]"));
+    MOCHI_CHECK_THROWS(ReadDocument(R"({"a" 1})"));
+    MOCHI_CHECK_THROWS(ReadDocument(R"({"a": 1,})"));
+    MOCHI_CHECK_THROWS(ReadDocument(R"({a: 1})"));
+    MOCHI_CHECK_THROWS(ReadDocument("tru"));
+    MOCHI_CHECK_THROWS(ReadDocument("nul"));
+    MOCHI_CHECK_THROWS(ReadDocument("-"));
+    MOCHI_CHECK_THROWS(ReadDocument("1."));
+    MOCHI_CHECK_THROWS(ReadDocument("1e"));
+    MOCHI_CHECK_THROWS(ReadDocument("01"));
+    MOCHI_CHECK_THROWS(ReadDocument("{} {}"));
+}
+
+MOCHI_TEST(JsonReader, NamesTheOffsetOfErrors) {
+    JsonReader reader("[1, x]");
+    std::string message;
+    try {
+        reader.ReadValue();
+    } catch (const std::runtime_error& error) {
+        message = error.what();
+    }
+
+    MOCHI_CHECK(message.find("offset 4") != std::string::npos);
+}
+
+MOCHI_TEST(JsonReader, LimitsNesting) {
+    auto nested = [](std::size_t depth) {
+        return std::string(depth, '[') + std::string(depth, ']');
+    };
+
+    ReadDocument(nested(JsonReader::MaxDepth));
+    MOCHI_CHECK_THROWS(ReadDocument(nested(JsonReader::MaxDepth + 1)));
+
+    // The reader only views its input
+    auto tooDeep = nested(JsonReader::MaxDepth + 1);
+    JsonReader reader(tooDeep);
+    MOCHI_CHECK_THROWS(reader.Skip());
+}
+
+MOCHI_TEST(JsonReader, KeepsIntegersExact) {
+    JsonReader reader("[9007199254740993, -9223372036854775808, 18446744073709551615, 18446744073709551616, 0.5]");
+    auto value = reader.ReadValue();
+
+    MOCHI_CHECK(value[0].isInt64());
+    MOCHI_CHECK_EQ(value[0].asInt64(), Json::Int64(9007199254740993));
+    MOCHI_CHECK_EQ(value[1].asInt64(), Json::Int64(INT64_MIN));
+    MOCHI_CHECK(value[2].isUInt64());
+    MOCHI_CHECK_EQ(value[2].asUInt64(), Json::UInt64(UINT64_MAX));
+    MOCHI_CHECK(value[3].isDouble() && !value[3].isUInt64());
+    MOCHI_CHECK_EQ(value[4].asDouble(), 0.5);
+}
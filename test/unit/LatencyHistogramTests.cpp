@@ -0,0 +1,75 @@
+//
+//  LatencyHistogramTests.cpp
+//  Mochi
+//
+
+#include "Test.h"
+#include <Mochi/LogMetrics.h>
+#include <cstdint>
+#include <memory>
+
+using namespace MOCHI_NAMESPACE;
+
+MOCHI_TEST(LatencyHistogram, KeepsSmallValuesExact) {
+    for (UInt64 value = 0; value < 2 * LatencyHistogram::SubBucketCount; value++) {
+        MOCHI_CHECK_EQ(LatencyHistogram::GetBucketIndex(value), (UInt32) value);
+        MOCHI_CHECK_EQ(LatencyHistogram::GetBucketUpperBound((UInt32) value), value);
+    }
+}
+
+MOCHI_TEST(LatencyHistogram, BoundsEveryValueWithinASubBucket) {
+    UInt32 previous = 0;
+    for (UInt32 bits = 0; bits < 64; bits++) {
+        for (UInt64 offset : { (UInt64) 0, (UInt64) 1, (UInt64) 3 }) {
+            auto value = ((UInt64) 1 << bits) + offset * ((UInt64) 1 << bits) / 4;
+            auto index = LatencyHistogram::GetBucketIndex(value);
+            auto upper = LatencyHistogram::GetBucketUpperBound(index);
+            auto lower = index == 0 ? 0 : LatencyHistogram::GetBucketUpperBound(index - 1) + 1;
+
+            MOCHI_CHECK(index < LatencyHistogram::BucketCount);
+            MOCHI_CHECK(index >= previous);
+            MOCHI_CHECK(lower <= value && value <= upper);
+            MOCHI_CHECK(upper - lower <= value / LatencyHistogram::SubBucketCount);
+            previous = index;
+        }
+    }
+
+    MOCHI_CHECK_EQ(LatencyHistogram::GetBucketIndex(UINT64_MAX), LatencyHistogram::BucketCount - 1);
+    MOCHI_CHECK_EQ(LatencyHistogram::GetBucketUpperBound(LatencyHistogram::BucketCount - 1), UINT64_MAX);
+}
+
+MOCHI_TEST(LatencyHistogram, ReportsNothingWhenEmpty) {
+    auto histogram = std::make_unique<LatencyHistogram>();
+    MOCHI_CHECK_EQ(histogram->GetCount(), UInt64(0));
+    MOCHI_CHECK_EQ(histogram->GetMean(), 0.0);
+    MOCHI_CHECK_EQ(histogram->GetValueAtPercentile(50), UInt64(0));
+}
+
+MOCHI_TEST(LatencyHistogram, FindsPercentiles) {
+    auto histogram = std::make_unique<LatencyHistogram>();
+    for (UInt64 value = 1; value <= 100; value++) {
+        histogram->Record(value);
+    }
+
+    MOCHI_CHECK_EQ(histogram->GetCount(), UInt64(100));
+    MOCHI_CHECK_EQ(histogram->GetMax(), UInt64(100));
+    MOCHI_CHECK_EQ(histogram->GetMean(), 50.5);
+
+    // Each result is the upper bound of the bucket the ranked value falls in
+    MOCHI_CHECK_EQ(histogram->GetValueAtPercentile(0), UInt64(1));
+    MOCHI_CHECK_EQ(histogram->GetValueAtPercentile(10), UInt64(10));
+    MOCHI_CHECK_EQ(histogram->GetValueAtPercentile(50), UInt64(51));
+    MOCHI_CHECK_EQ(histogram->GetValueAtPercentile(99), UInt64(99));
+    MOCHI_CHECK_EQ(histogram->GetValueAtPercentile(100), UInt64(100));
+    MOCHI_CHECK_EQ(histogram->GetValueAtPercentile(250), UInt64(100));
+}
+
+MOCHI_TEST(LatencyHistogram, CapsPercentilesAtTheMaximum) {
+    auto histogram = std::make_unique<LatencyHistogram>();
+    histogram->Record(34);
+
+    // 34 shares its bucket with 35
+    MOCHI_CHECK_EQ(LatencyHistogram::GetBucketUpperBound(LatencyHistogram::GetBucketIndex(34)), UInt64(35));
+    MOCHI_CHECK_EQ(histogram->GetValueAtPercentile(100), UInt64(34));
+    MOCHI_CHECK_EQ(histogram->GetBucketCount(LatencyHistogram::GetBucketIndex(34)), UInt64(1));
+}
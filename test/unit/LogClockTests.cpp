@@ -0,0 +1,86 @@
+//
+//  LogClockTests.cpp
+//  Mochi
+//
+
+#include "Test.h"
+#include <Mochi/LogClock.h>
+#include <chrono>
+#include <string>
+
+using namespace MOCHI_NAMESPACE;
+
+static LogClock::TimePoint FromMicros(Int64 micros) {
+    return LogClock::TimePoint(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::microseconds(micros)));
+}
+
+// 2023-11-14 22:13:20 UTC
+static constexpr Int64 BaseMicros = 1700000000LL * 1000000;
+
+MOCHI_TEST(TimestampFormatter, FormatsEachPrecision) {
+    auto timestamp = FromMicros(BaseMicros + 123456);
+
+    MOCHI_CHECK_EQ(TimestampFormatter(TimestampPrecision::Seconds, true).Format(timestamp),
+                   std::string("2023-11-14 22:13:20"));
+    MOCHI_CHECK_EQ(TimestampFormatter(TimestampPrecision::Milliseconds, true).Format(timestamp),
+                   std::string("2023-11-14 22:13:20.123"));
+    MOCHI_CHECK_EQ(TimestampFormatter(TimestampPrecision::Microseconds, true).Format(timestamp),
+                   std::string("2023-11-14 22:13:20.123456"));
+}
+
+MOCHI_TEST(TimestampFormatter, RewritesOnlyTheFractionWithinASecond) {
+    TimestampFormatter formatter(TimestampPrecision::Milliseconds, true);
+
+    MOCHI_CHECK_EQ(formatter.Format(FromMicros(BaseMicros + 5000)), std::string("2023-11-14 22:13:20.005"));
+    MOCHI_CHECK_EQ(formatter.Format(FromMicros(BaseMicros + 999999)), std::string("2023-11-14 22:13:20.999"));
+    MOCHI_CHECK_EQ(formatter.Format(FromMicros(BaseMicros)), std::string("2023-11-14 22:13:20.000"));
+}
+
+MOCHI_TEST(TimestampFormatter, RollsOverToTheNextSecondAndDay) {
+    TimestampFormatter formatter(TimestampPrecision::Milliseconds, true);
+
+    MOCHI_CHECK_EQ(formatter.Format(FromMicros(BaseMicros + 999000)), std::string("2023-11-14 22:13:20.999"));
+    MOCHI_CHECK_EQ(formatter.Format(FromMicros(BaseMicros + 1000000)), std::string("2023-11-14 22:13:21.000"));
+
+    // The last microsecond of the day, then midnight
+    auto midnight = BaseMicros + 6400LL * 1000000;
+    MOCHI_CHECK_EQ(formatter.Format(FromMicros(midnight - 1)), std::string("2023-11-14 23:59:59.999"));
+    MOCHI_CHECK_EQ(formatter.Format(FromMicros(midnight)), std::string("2023-11-15 00:00:00.000"));
+
+    // Going back in time recomputes the cached second as well
+    MOCHI_CHECK_EQ(formatter.Format(FromMicros(BaseMicros)), std::string("2023-11-14 22:13:20.000"));
+}
+
+MOCHI_TEST(TimestampFormatter, FormatsTimesBeforeTheEpoch) {
+    TimestampFormatter formatter(TimestampPrecision::Microseconds, true);
+    MOCHI_CHECK_EQ(formatter.Format(FromMicros(-1)), std::string("1969-12-31 23:59:59.999999"));
+    MOCHI_CHECK_EQ(formatter.Format(FromMicros(0)), std::string("1970-01-01 00:00:00.000000"));
+}
+
+MOCHI_TEST(TimestampFormatter, AppendsToTheOutput) {
+    TimestampFormatter formatter(TimestampPrecision::Seconds, true);
+    std::string out = "[";
+    formatter.Append(out, FromMicros(BaseMicros));
+    out += "] ";
+    formatter.Append(out, FromMicros(BaseMicros + 1000000));
+
+    MOCHI_CHECK_EQ(out, std::string("[2023-11-14 22:13:20] 2023-11-14 22:13:21"));
+}
+
+MOCHI_TEST(LogClock, FollowsTheSystemClock) {
+    auto previous = LogClock::GetSource();
+    for (auto source : { LogClockSource::System, LogClockSource::Coarse }) {
+        if (!LogClock::SetSource(source)) continue;
+
+        auto before = std::chrono::system_clock::now();
+        auto now = LogClock::Now();
+        auto after = std::chrono::system_clock::now();
+
+        // The coarse clock may lag by a scheduler tick
+        MOCHI_CHECK(now >= before - std::chrono::milliseconds(50));
+        MOCHI_CHECK(now <= after);
+    }
+
+    LogClock::SetSource(previous);
+}
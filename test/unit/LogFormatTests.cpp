@@ -0,0 +1,56 @@
+//
+//  LogFormatTests.cpp
+//  Mochi
+//
+
+#include "Test.h"
+#include <Mochi/Logging.h>
+#include <cstdint>
+#include <string>
+
+using namespace MOCHI_NAMESPACE;
+
+MOCHI_TEST(LogArguments, HashesLikeTheyFormat) {
+    // Same message, same hash
+    MOCHI_CHECK_EQ(LogArguments::Hash(5), LogArguments::Hash(5L));
+    MOCHI_CHECK_EQ(LogArguments::Hash(std::string("text")), LogArguments::Hash("text"));
+    MOCHI_CHECK_EQ(LogArguments::Hash((const char*) nullptr), LogArguments::Hash("(null)"));
+
+    // Different messages from the same bits
+    MOCHI_CHECK(LogArguments::Hash(-1) != LogArguments::Hash(UINT64_MAX));
+    MOCHI_CHECK(LogArguments::Hash(true) != LogArguments::Hash(1));
+    MOCHI_CHECK(LogArguments::Hash('a') != LogArguments::Hash(97));
+    MOCHI_CHECK(LogArguments::Hash(true) != LogArguments::Hash('\x01'));
+}
+
+MOCHI_TEST(LogArguments, FormatsPackedArguments) {
+    LogArguments::Buffer buffer;
+    LogArguments::Encode(buffer, -1, UINT64_MAX, true, 'x', 1.5, "text", (const char*) nullptr);
+
+    std::string text;
+    LogArguments::Format("{} {} {} {} {} {} {} {{}}", buffer, text);
+    MOCHI_CHECK_EQ(text, std::string("-1 18446744073709551615 true x 1.5 text (null) {}"));
+}
+
+MOCHI_TEST(LogRateLimiter, ZeroRateLetsNothingThrough) {
+    LogRateLimiter closed(0);
+    LogRateLimiter negative(-5, 10);
+
+    UInt64 suppressed = 0;
+    for (int i = 0; i < 3; i++) {
+        MOCHI_CHECK(!closed.TryAcquire(suppressed));
+        MOCHI_CHECK(!negative.TryAcquire(suppressed));
+    }
+}
+
+MOCHI_TEST(LogRateLimiter, LetsBurstsThrough) {
+    // Slow enough that no token is refilled while the test runs
+    LogRateLimiter limiter(0.001, 3);
+
+    UInt64 suppressed = 0;
+    MOCHI_CHECK(limiter.TryAcquire(suppressed));
+    MOCHI_CHECK(limiter.TryAcquire(suppressed));
+    MOCHI_CHECK(limiter.TryAcquire(suppressed));
+    MOCHI_CHECK(!limiter.TryAcquire(suppressed));
+    MOCHI_CHECK(!limiter.TryAcquire(suppressed));
+}
@@ -0,0 +1,177 @@
+//
+//  LogTaskTests.cpp
+//  Mochi
+//
+
+#include "Test.h"
+#include <Mochi/LogTask.h>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <future>
+#include <stdexcept>
+#include <utility>
+
+using namespace MOCHI_NAMESPACE;
+
+// Suspends the coroutine and hands its handle to the test, which resumes it later
+struct ParkAwaiter {
+    std::coroutine_handle<>* parked;
+
+    Bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) noexcept { *parked = handle; }
+    void await_resume() const noexcept {}
+};
+
+// Reads the address of the frame without suspending
+struct FrameAwaiter {
+    void** frame;
+
+    Bool await_ready() const noexcept { return false; }
+    Bool await_suspend(std::coroutine_handle<> handle) noexcept {
+        *frame = handle.address();
+        return false;
+    }
+    void await_resume() const noexcept {}
+};
+
+// Sets a flag once destroyed. Passed by value, the copy in the frame goes with the frame.
+struct FrameGuard {
+    Bool* destroyed;
+
+    explicit FrameGuard(Bool* destroyed) : destroyed(destroyed) {}
+    FrameGuard(FrameGuard&& other) noexcept : destroyed(std::exchange(other.destroyed, nullptr)) {}
+    ~FrameGuard() { if (destroyed) *destroyed = true; }
+};
+
+static LogTask Park(std::coroutine_handle<>* parked, [[maybe_unused]] FrameGuard guard, Bool* finished) {
+    co_await ParkAwaiter { parked };
+    *finished = true;
+}
+
+static LogTask Touch(void** frame) {
+    co_await FrameAwaiter { frame };
+}
+
+static LogTask Throw() {
+    throw std::runtime_error("handler failed");
+    co_return;
+}
+
+MOCHI_TEST(LogTask, FinishesWithoutSuspending) {
+    void* frame = nullptr;
+    std::atomic<std::size_t> pending = 0;
+
+    auto task = Touch(&frame);
+    MOCHI_CHECK(task.IsDone());
+    task.Detach(&pending);
+    MOCHI_CHECK_EQ(pending.load(), std::size_t(0));
+    MOCHI_CHECK(task.IsDone());
+}
+
+MOCHI_TEST(LogTask, CountsDetachedTasksUntilTheyFinish) {
+    std::coroutine_handle<> parked;
+    Bool destroyed = false, finished = false;
+    std::atomic<std::size_t> pending = 0;
+
+    auto task = Park(&parked, FrameGuard(&destroyed), &finished);
+    MOCHI_CHECK(!task.IsDone());
+    task.Detach(&pending);
+    MOCHI_CHECK_EQ(pending.load(), std::size_t(1));
+    MOCHI_CHECK(!destroyed);
+
+    // The coroutine destroys its own frame once nobody holds the task
+    parked.resume();
+    MOCHI_CHECK(finished);
+    MOCHI_CHECK(destroyed);
+    MOCHI_CHECK_EQ(pending.load(), std::size_t(0));
+}
+
+MOCHI_TEST(LogTask, OwnerDestroysTasksThatFinishedFirst) {
+    std::coroutine_handle<> parked;
+    Bool destroyed = false, finished = false;
+    {
+        auto task = Park(&parked, FrameGuard(&destroyed), &finished);
+        parked.resume();
+        MOCHI_CHECK(task.IsDone());
+        MOCHI_CHECK(!destroyed);
+    }
+
+    MOCHI_CHECK(finished);
+    MOCHI_CHECK(destroyed);
+}
+
+MOCHI_TEST(LogTask, KeepsRunningAfterTheTaskIsDropped) {
+    std::coroutine_handle<> parked;
+    Bool destroyed = false, finished = false;
+    {
+        auto task = Park(&parked, FrameGuard(&destroyed), &finished);
+    }
+
+    MOCHI_CHECK(!destroyed);
+    parked.resume();
+    MOCHI_CHECK(finished);
+    MOCHI_CHECK(destroyed);
+}
+
+MOCHI_TEST(LogTask, ReusesFramesOnTheSameThread) {
+    void* first = nullptr;
+    void* second = nullptr;
+    Touch(&first);
+    Touch(&second);
+
+    MOCHI_CHECK(first != nullptr);
+    MOCHI_CHECK(first == second);
+}
+
+MOCHI_TEST(LogTask, ReusesFramesFinishedOnAnotherThread) {
+    std::coroutine_handle<> parked;
+    Bool destroyed = false, finished = false;
+    Park(&parked, FrameGuard(&destroyed), &finished);
+
+    // The frame goes to the cache of the thread that finished it, and is reused there
+    void* freed = parked.address();
+    void* reused = nullptr;
+    std::async(std::launch::async, [&] {
+        parked.resume();
+        std::coroutine_handle<> next;
+        Bool nextDestroyed = false, nextFinished = false;
+        Park(&next, FrameGuard(&nextDestroyed), &nextFinished);
+        reused = next.address();
+        next.resume();
+    }).wait();
+
+    MOCHI_CHECK(destroyed);
+    MOCHI_CHECK(freed == reused);
+}
+
+MOCHI_TEST(LogTask, ReportsExceptionsAndFinishes) {
+    std::atomic<std::size_t> pending = 0;
+    auto task = Throw();
+    MOCHI_CHECK(task.IsDone());
+    task.Detach(&pending);
+    MOCHI_CHECK_EQ(pending.load(), std::size_t(0));
+}
+
+MOCHI_TEST(LogTaskDelegate, FlushWaitsForSuspendedHandlers) {
+    std::coroutine_handle<> parked;
+    Bool destroyed = false, finished = false;
+    auto delegate = LogTaskDelegate::Create([&](Handle<LoggerEventArgs>) {
+        return Park(&parked, FrameGuard(&destroyed), &finished);
+    });
+
+    LoggerEventPool pool(4);
+    auto event = pool.Acquire(LogLevel::Info, "text", nullptr, "Tag");
+    delegate->Deliver(LoggerEventBatch(&event, 1));
+
+    auto taskDelegate = std::static_pointer_cast<LogTaskDelegate>(delegate);
+    MOCHI_CHECK_EQ(taskDelegate->GetPendingCount(), std::size_t(1));
+
+    auto flushed = std::async(std::launch::async, [&] { delegate->Flush().wait(); });
+    MOCHI_CHECK(flushed.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+
+    parked.resume();
+    MOCHI_CHECK(flushed.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    MOCHI_CHECK(finished);
+    MOCHI_CHECK_EQ(taskDelegate->GetPendingCount(), std::size_t(0));
+}
@@ -0,0 +1,51 @@
+//
+//  Main.cpp
+//  Mochi
+//
+//  Runs every registered unit test, or only those whose name contains the first argument.
+//  Exits with 1 if any of them failed.
+//
+
+#include "Test.h"
+#include <cstdio>
+#include <exception>
+#include <string_view>
+
+namespace MochiTest {
+
+    std::vector<TestCase>& GetTests() {
+        static std::vector<TestCase> tests;
+        return tests;
+    }
+
+    Registration::Registration(const char* suite, const char* name, Body body) {
+        GetTests().push_back({ std::string(suite) + "." + name, std::move(body) });
+    }
+
+    void Fail(const char* file, int line, const std::string& message) {
+        throw Failure(std::string(file) + ":" + std::to_string(line) + ": " + message);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    std::string_view filter = argc > 1 ? argv[1] : "";
+
+    std::size_t run = 0;
+    std::size_t failed = 0;
+    for (auto& test : MochiTest::GetTests()) {
+        if (test.name.find(filter) == std::string::npos) continue;
+        run++;
+
+        try {
+            test.body();
+            std::printf("[  OK  ] %s\n", test.name.c_str());
+        } catch (const std::exception& ex) {
+            failed++;
+            std::printf("[ FAIL ] %s\n         %s\n", test.name.c_str(), ex.what());
+        }
+    }
+
+    std::printf("%zu tests, %zu failed\n", run, failed);
+    return failed == 0 ? 0 : 1;
+}
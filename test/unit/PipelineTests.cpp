@@ -0,0 +1,170 @@
+//
+//  PipelineTests.cpp
+//  Mochi
+//
+
+#include "Test.h"
+#include <Mochi/Logging.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MOCHI_NAMESPACE;
+
+static Handle<IAsyncLogEventDelegate> CreateRecorder(std::vector<std::string>& texts) {
+    return IAsyncLogEventDelegate::Create([&texts](Handle<LoggerEventArgs> ev) {
+        auto& text = texts.emplace_back();
+        Component::AppendPlainText(ev->content, text);
+        return Future::Completed();
+    });
+}
+
+MOCHI_TEST(Pipeline, DropOldestKeepsHooks) {
+    LogPipeline pipeline(8);
+    std::vector<std::string> texts;
+    pipeline.AddLoggedListener(CreateRecorder(texts));
+    pipeline.SetQueueFullPolicy(QueueFullPolicy::DropOldest);
+    pipeline.RunManualPoll();
+
+    // Nothing is polled until the producer is done, so the hook at the front of the queue
+    // keeps getting in the way of the events being dropped
+    std::future<void> flushed;
+    std::thread producer([&] {
+        flushed = pipeline.FlushAsync();
+        for (int i = 0; i < 40; i++) {
+            pipeline.Info("Event {}", i);
+        }
+    });
+    producer.join();
+
+    pipeline.PollEvents();
+
+    MOCHI_CHECK(flushed.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    MOCHI_CHECK_EQ(pipeline.GetDroppedCount(), UInt64(33));
+    MOCHI_CHECK(texts.size() >= 7);
+    MOCHI_CHECK_EQ(texts[6], std::string("Event 39"));
+}
+
+MOCHI_TEST(Pipeline, ChangesListenersWhileRunning) {
+    LogPipeline pipeline;
+    pipeline.RunThreaded();
+
+    std::vector<std::string> first, second;
+    auto firstRecorder = CreateRecorder(first);
+    auto secondRecorder = CreateRecorder(second);
+
+    pipeline.AddLoggedListener(firstRecorder);
+    pipeline.AddLoggedListener(secondRecorder, LogSinkDispatch::Dedicated);
+    pipeline.Info("Both");
+    pipeline.FlushAsync().wait();
+
+    pipeline.RemoveLoggedListener(firstRecorder);
+    pipeline.Info("Second only");
+    pipeline.FlushAsync().wait();
+
+    pipeline.RemoveLoggedListener(secondRecorder);
+    pipeline.Info("Neither");
+    pipeline.FlushAsync().wait();
+    pipeline.Join();
+
+    MOCHI_CHECK_EQ(first.size(), std::size_t(1));
+    MOCHI_CHECK_EQ(first[0], std::string("Both"));
+    MOCHI_CHECK_EQ(second.size(), std::size_t(2));
+    MOCHI_CHECK_EQ(second[1], std::string("Second only"));
+}
+
+MOCHI_TEST(Pipeline, AppliesListenerChangesOnThePollingThread) {
+    LogPipeline pipeline;
+    pipeline.RunManualPoll();
+
+    std::vector<std::string> texts;
+    std::thread other([&] {
+        pipeline.AddLoggedListener(CreateRecorder(texts));
+        pipeline.Info("Queued after the change");
+    });
+    other.join();
+
+    MOCHI_CHECK_EQ(pipeline.GetMetrics().sinks.size(), std::size_t(0));
+    pipeline.PollEvents();
+    MOCHI_CHECK_EQ(pipeline.GetMetrics().sinks.size(), std::size_t(1));
+    MOCHI_CHECK_EQ(texts.size(), std::size_t(1));
+}
+
+MOCHI_TEST(Pipeline, WarnsWhenNotBootstrapped) {
+    LogPipeline pipeline;
+    std::vector<std::string> texts;
+    pipeline.AddLoggedListener(CreateRecorder(texts));
+
+    // Starts the threaded event loop on its own
+    pipeline.Info("First");
+    pipeline.FlushAsync().wait();
+    pipeline.Join();
+
+    MOCHI_CHECK_EQ(texts.size(), std::size_t(4));
+    MOCHI_CHECK_EQ(texts[0], std::string("*** Logger is not bootstrapped. ***"));
+    MOCHI_CHECK_EQ(texts[3], std::string("First"));
+}
+
+MOCHI_TEST(Pipeline, ReadsMetricsWhileListenersChange) {
+    LogPipeline pipeline;
+    pipeline.RunThreaded();
+
+    std::atomic<Bool> isDone = false;
+    std::size_t reads = 0;
+    std::thread reader([&] {
+        while (!isDone) {
+            reads += pipeline.GetMetrics().sinks.size() <= 2;
+        }
+    });
+
+    std::vector<std::string> first, second;
+    for (int i = 0; i < 50; i++) {
+        auto firstRecorder = CreateRecorder(first);
+        auto secondRecorder = CreateRecorder(second);
+        pipeline.AddLoggedListener(firstRecorder);
+        pipeline.AddLoggedListener(secondRecorder, LogSinkDispatch::Dedicated);
+        pipeline.RemoveLoggedListener(firstRecorder);
+        pipeline.RemoveLoggedListener(secondRecorder);
+    }
+
+    isDone = true;
+    reader.join();
+    pipeline.Join();
+
+    MOCHI_CHECK(reads > 0);
+    MOCHI_CHECK_EQ(pipeline.GetMetrics().sinks.size(), std::size_t(0));
+}
+
+MOCHI_TEST(Pipeline, CountsWhatItDispatches) {
+    LogPipeline pipeline(16);
+    std::vector<std::string> texts;
+    auto recorder = CreateRecorder(texts);
+    pipeline.AddLoggedListener(recorder);
+    pipeline.RunManualPoll();
+
+    // Logged from another thread, since the polling thread handles its own events right away
+    std::thread([&] {
+        for (int i = 0; i < 5; i++) {
+            pipeline.Info("Event {}", i);
+        }
+    }).join();
+
+    auto before = pipeline.GetMetrics();
+    MOCHI_CHECK_EQ(before.queueCapacity, std::size_t(16));
+    MOCHI_CHECK_EQ(before.queueDepth, std::size_t(5));
+    MOCHI_CHECK_EQ(before.enqueued, UInt64(5));
+    MOCHI_CHECK_EQ(before.dispatched, UInt64(0));
+
+    pipeline.PollEvents();
+    auto after = pipeline.GetMetrics();
+    MOCHI_CHECK_EQ(after.queueDepth, std::size_t(0));
+    MOCHI_CHECK_EQ(after.queueHighWater, std::size_t(5));
+    MOCHI_CHECK_EQ(after.dispatched, UInt64(5));
+    MOCHI_CHECK_EQ(after.latencySamples, UInt64(5));
+    MOCHI_CHECK(after.latencyP50 <= after.latencyMax);
+    MOCHI_CHECK_EQ(after.sinks.size(), std::size_t(1));
+    MOCHI_CHECK(after.sinks[0].handler == recorder);
+    MOCHI_CHECK_EQ(after.sinks[0].events, UInt64(5));
+}
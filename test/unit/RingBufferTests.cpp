@@ -0,0 +1,95 @@
+//
+//  RingBufferTests.cpp
+//  Mochi
+//
+
+#include "Test.h"
+#include <Mochi/Concurrent.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace MOCHI_NAMESPACE;
+
+MOCHI_TEST(RingBuffer, RoundsCapacityUpAndRejectsWhenFull) {
+    ConcurrentRingBuffer<int> buffer(5);
+    MOCHI_CHECK_EQ(buffer.GetCapacity(), std::size_t(8));
+
+    for (int i = 0; i < 8; i++) MOCHI_CHECK(buffer.TryEnqueue(i));
+
+    MOCHI_CHECK(!buffer.TryEnqueue(8));
+    MOCHI_CHECK_EQ(buffer.GetSize(), std::size_t(8));
+
+    int value = -1;
+    for (int i = 0; i < 8; i++) {
+        MOCHI_CHECK(buffer.TryDequeue(value));
+        MOCHI_CHECK_EQ(value, i);
+    }
+
+    MOCHI_CHECK(!buffer.TryDequeue(value));
+    MOCHI_CHECK(buffer.IsEmpty());
+}
+
+MOCHI_TEST(RingBuffer, LeavesRejectedValuesUntouched) {
+    ConcurrentRingBuffer<std::unique_ptr<int>> buffer(2);
+    MOCHI_CHECK(buffer.TryEnqueue(std::make_unique<int>(1)));
+    MOCHI_CHECK(buffer.TryEnqueue(std::make_unique<int>(2)));
+
+    auto rejected = std::make_unique<int>(3);
+    MOCHI_CHECK(!buffer.TryEnqueue(std::move(rejected)));
+    MOCHI_CHECK(rejected != nullptr);
+}
+
+MOCHI_TEST(RingBuffer, DeliversEveryValueOnceUnderContention) {
+    constexpr int Producers = 4;
+    constexpr int Consumers = 4;
+    constexpr int PerProducer = 50000;
+    constexpr int Total = Producers * PerProducer;
+
+    // Small enough that producers keep running into a full buffer
+    ConcurrentRingBuffer<int> buffer(64);
+    std::vector<std::atomic<int>> seen(Total);
+    std::atomic<int> consumed { 0 };
+    std::atomic<Bool> outOfOrder { false };
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < Producers; p++) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < PerProducer; i++) {
+                while (!buffer.TryEnqueue(p * PerProducer + i)) std::this_thread::yield();
+            }
+        });
+    }
+
+    for (int c = 0; c < Consumers; c++) {
+        threads.emplace_back([&] {
+            // Values of one producer come out in the order it put them in
+            std::vector<int> last(Producers, -1);
+            int value;
+            while (consumed.load(std::memory_order_relaxed) < Total) {
+                if (!buffer.TryDequeue(value)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                auto producer = value / PerProducer;
+                if (value <= last[producer]) outOfOrder = true;
+                last[producer] = value;
+
+                seen[value].fetch_add(1, std::memory_order_relaxed);
+                consumed.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (auto& thread : threads) thread.join();
+
+    MOCHI_CHECK(!outOfOrder);
+    MOCHI_CHECK_EQ(consumed.load(), Total);
+    MOCHI_CHECK_EQ(buffer.GetEnqueuedCount(), std::size_t(Total));
+    MOCHI_CHECK(buffer.IsEmpty());
+    for (int i = 0; i < Total; i++) {
+        if (seen[i].load() != 1) MOCHI_CHECK_EQ(seen[i].load(), 1);
+    }
+}
@@ -0,0 +1,77 @@
+//
+//  Test.h
+//  Mochi
+//
+//  A minimal harness for the Mochi-unittest suites. Tests register themselves through
+//  `MOCHI_TEST`; a failed check throws, so the rest of that test is skipped and the
+//  runner moves on to the next one.
+//
+
+#pragma once
+
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace MochiTest {
+
+    using Body = std::function<void()>;
+
+    struct TestCase {
+        std::string name;
+        Body body;
+    };
+
+    /// @brief Thrown by a failed check.
+    class Failure : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    std::vector<TestCase>& GetTests();
+
+    struct Registration {
+        Registration(const char* suite, const char* name, Body body);
+    };
+
+    [[noreturn]] void Fail(const char* file, int line, const std::string& message);
+
+    template <typename TLeft, typename TRight>
+    void CheckEqual(const TLeft& left, const TRight& right,
+                    const char* leftText, const char* rightText,
+                    const char* file, int line) {
+        if (left == right) return;
+
+        std::stringstream message;
+        message << leftText << " == " << rightText;
+        if constexpr (requires(std::ostream& out) { out << left; out << right; }) {
+            message << " (" << left << " vs " << right << ")";
+        }
+
+        Fail(file, line, message.str());
+    }
+
+}
+
+#define MOCHI_TEST(suite, name)                                                             \
+    static void suite##_##name();                                                           \
+    static ::MochiTest::Registration suite##_##name##_registration(#suite, #name,           \
+                                                                   suite##_##name);         \
+    static void suite##_##name()
+
+#define MOCHI_CHECK(condition)                                                              \
+    do {                                                                                    \
+        if (!(condition)) ::MochiTest::Fail(__FILE__, __LINE__, #condition);                \
+    } while (0)
+
+#define MOCHI_CHECK_EQ(left, right)                                                         \
+    ::MochiTest::CheckEqual((left), (right), #left, #right, __FILE__, __LINE__)
+
+#define MOCHI_CHECK_THROWS(expression)                                                      \
+    do {                                                                                    \
+        bool thrown = false;                                                                \
+        try { (void) (expression); } catch (...) { thrown = true; }                         \
+        if (!thrown) ::MochiTest::Fail(__FILE__, __LINE__, #expression " did not throw");   \
+    } while (0)
@@ -0,0 +1,90 @@
+//
+// Turns a file written by BinaryLogSink back into text, or recovers the records left
+// in a LogCrashRing file with --crash.
+//
+
+#include <Mochi/LogSinks.h>
+#include <Mochi/LogCrashRing.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+
+using MBinaryLogDecoder = ::MOCHI_NAMESPACE::BinaryLogDecoder;
+using MDecodedLogRecord = ::MOCHI_NAMESPACE::DecodedLogRecord;
+using MTimestampFormatter = ::MOCHI_NAMESPACE::TimestampFormatter;
+using MLogCrashRing = ::MOCHI_NAMESPACE::LogCrashRing;
+
+static void PrintRecord(MTimestampFormatter& timestamps, const MDecodedLogRecord& record) {
+    std::string time;
+    timestamps.Append(time, record.timestamp);
+
+    std::cout << time << " "
+              << "[Thread@" << record.thread << "] "
+              << "[" << ::MOCHI_NAMESPACE::GetLogLevelName(record.level) << "] "
+              << "[" << record.tag << "] "
+              << record.text;
+
+    std::string value;
+    for (auto field : record.fields) {
+        value.clear();
+        field.AppendValue(value);
+        std::cout << " " << field.GetKey() << "=" << value;
+    }
+
+    std::cout << "\n";
+}
+
+static int RecoverCrashRing(const std::string& path, const char* countArgument) {
+    try {
+        auto count = countArgument ? (std::size_t) std::stoull(countArgument) : std::numeric_limits<std::size_t>::max();
+        MTimestampFormatter timestamps(::MOCHI_NAMESPACE::TimestampPrecision::Microseconds);
+        for (auto &record : MLogCrashRing::Recover(path, count)) {
+            PrintRecord(timestamps, record);
+        }
+    } catch (const std::exception& ex) {
+        std::cout.flush();
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <file>\n"
+                  << "       " << argv[0] << " --crash <file> [count]\n";
+        return 1;
+    }
+
+    if (std::string(argv[1]) == "--crash") {
+        if (argc < 3) {
+            std::cerr << "Usage: " << argv[0] << " --crash <file> [count]\n";
+            return 1;
+        }
+
+        return RecoverCrashRing(argv[2], argc > 3 ? argv[3] : nullptr);
+    }
+
+    std::ifstream stream(argv[1], std::ios::binary);
+    if (!stream) {
+        std::cerr << "Cannot open " << argv[1] << "\n";
+        return 1;
+    }
+
+    try {
+        MBinaryLogDecoder decoder(stream);
+        MDecodedLogRecord record;
+        MTimestampFormatter timestamps;
+
+        while (decoder.Next(record)) {
+            PrintRecord(timestamps, record);
+        }
+    } catch (const std::exception& ex) {
+        std::cout.flush();
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}